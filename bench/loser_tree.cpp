@@ -0,0 +1,134 @@
+// Copyright (c) 2016, Lingxi Li <lilingxi.cs@gmail.com>
+// All rights reserved.
+// Happy Hacking CXX Library (https://github.com/Lingxi-Li/Happy_Hacking_CXX)
+
+// Compares `kway_merge` with merging through `mutable_priority_heap` and
+// `mutable_heap` keyed by run index, on many sorted runs of random integers.
+// Build in release mode.
+// Usage: bench_loser_tree [number of runs] [run length]
+
+#include <hhxx/loser_tree.hpp>
+#include <hhxx/mutable_heap.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+using runs_type = std::vector<std::vector<std::uint64_t>>;
+
+// Counts calls of `Less`, if `counted` is set.
+template <class Less>
+struct counting {
+  bool operator()(std::uint64_t a, std::uint64_t b) const {
+    if (counted) ++*counted;
+    return Less{}(a, b);
+  }
+  std::uint64_t* counted;
+};
+
+std::uint64_t merge_loser_tree(const runs_type& runs,
+                               std::vector<std::uint64_t>& out,
+                               std::uint64_t* counted) {
+  using less = counting<std::less<std::uint64_t>>;
+  hhxx::kway_merge(runs.begin(), runs.end(), out.begin(), less{counted});
+  return out.back();
+}
+
+std::uint64_t merge_heap(const runs_type& runs,
+                         std::vector<std::uint64_t>& out,
+                         std::uint64_t* counted) {
+  using less = counting<std::greater<std::uint64_t>>;
+  using heap_type = hhxx::mutable_priority_heap<
+                      std::uint64_t, less, hhxx::dense_pos_index>;
+  std::vector<std::size_t> cur(runs.size());
+  heap_type heap(less{counted});
+  heap.reserve(runs.size());
+  for (std::uintptr_t run = 0; run < runs.size(); ++run) {
+    if (! runs[run].empty()) heap.push(run, runs[run][0]);
+  }
+  auto it = out.begin();
+  while (! heap.empty()) {
+    auto run = heap.top();
+    *it++ = heap.top_priority();
+    if (++cur[run] < runs[run].size()) {
+      heap.decrease(run, runs[run][cur[run]]);
+    }
+    else {
+      heap.pop();
+    }
+  }
+  return out.back();
+}
+
+// Merges as `mutable_heap` of run indices ordered by run heads would.
+std::uint64_t merge_mutable_heap(const runs_type& runs,
+                                 std::vector<std::uint64_t>& out,
+                                 std::uint64_t* counted) {
+  std::vector<std::size_t> cur(runs.size());
+  auto head = [&](std::uintptr_t run) {
+    return runs[run][cur[run]];
+  };
+  auto less = [&](std::uintptr_t a, std::uintptr_t b) {
+    if (counted) ++*counted;
+    return head(b) < head(a);
+  };
+  hhxx::mutable_heap<decltype(less)> heap(less);
+  for (std::uintptr_t run = 0; run < runs.size(); ++run) {
+    if (! runs[run].empty()) heap.push(run);
+  }
+  auto it = out.begin();
+  while (! heap.empty()) {
+    auto run = heap.top();
+    *it++ = head(run);
+    if (++cur[run] < runs[run].size()) {
+      heap.decrease(run);
+    }
+    else {
+      heap.pop();
+    }
+  }
+  return out.back();
+}
+
+// Times the merge, then reruns it untimed to count comparisons.
+template <class F>
+void run(const char* name, F merge, const runs_type& runs, std::size_t n) {
+  std::vector<std::uint64_t> out(n);
+  auto start = std::chrono::steady_clock::now();
+  auto checksum = merge(runs, out, nullptr);
+  auto stop = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = stop - start;
+  std::uint64_t counted = 0;
+  merge(runs, out, &counted);
+  std::printf("%-24s %10.1f ms  %6.2f cmp/element  (checksum %llu)\n", name,
+              elapsed.count(), counted / double(n),
+              static_cast<unsigned long long>(checksum));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::size_t k = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 512;
+  std::size_t len = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1u << 14;
+  std::printf("%zu runs of %zu\n", k, len);
+  std::mt19937_64 rand(k);
+  runs_type runs(k, std::vector<std::uint64_t>(len));
+  for (auto& r : runs) {
+    for (auto& x : r) {
+      x = rand();
+    }
+    std::sort(r.begin(), r.end());
+  }
+  run("loser tree", merge_loser_tree, runs, k * len);
+  run("mutable_priority_heap", merge_heap, runs, k * len);
+  run("mutable_heap", merge_mutable_heap, runs, k * len);
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2016, Lingxi Li <lilingxi.cs@gmail.com>
+// All rights reserved.
+// Happy Hacking CXX Library (https://github.com/Lingxi-Li/Happy_Hacking_CXX)
+
+// Compares heap layouts and arities of `mutable_priority_heap` on a workload of
+// pushes, priority increases, and pops. Also reports work per key counted by
+// `heap_stats`. Build in release mode.
+// Usage: bench_mutable_heap [number of keys]
+
+#include <hhxx/mutable_heap.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct workload {
+  explicit workload(std::size_t n) {
+    std::mt19937_64 rand(n);
+    priorities.resize(n);
+    for (auto& priority : priorities) {
+      priority = rand() >> 1;
+    }
+    updates.resize(n / 2);
+    for (auto& update : updates) {
+      update.second = rand() % n;
+      update.first = priorities[update.second] + (rand() >> 2);
+    }
+  }
+  std::vector<std::uint64_t> priorities;
+  std::vector<std::pair<std::uint64_t, std::uintptr_t>> updates;
+};
+
+template <class Heap>
+std::uintptr_t drive(Heap& heap, const workload& work) {
+  auto n = work.priorities.size();
+  heap.reserve(n);
+  for (std::uintptr_t key = 0; key < n; ++key) {
+    heap.push(key, work.priorities[key]);
+  }
+  for (const auto& update : work.updates) {
+    heap.push(update.second, update.first);
+  }
+  std::uintptr_t checksum = 0;
+  while (! heap.empty()) {
+    checksum += heap.pop();
+  }
+  return checksum;
+}
+
+template <std::size_t arity, class Layout, class Stats>
+using heap_type = hhxx::mutable_priority_heap<
+                    std::uint64_t, std::less<std::uint64_t>,
+                    hhxx::dense_pos_index, arity, Layout,
+                    std::allocator<std::uintptr_t>, Stats>;
+
+// Times the workload, then reruns it untimed to count the work done.
+template <std::size_t arity, class Layout>
+void run(const char* name, const workload& work) {
+  heap_type<arity, Layout, hhxx::no_heap_stats> heap;
+  auto start = std::chrono::steady_clock::now();
+  auto checksum = drive(heap, work);
+  auto stop = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = stop - start;
+  heap_type<arity, Layout, hhxx::heap_stats> counted;
+  drive(counted, work);
+  const auto& stats = counted.stats();
+  std::printf("%-24s %10.1f ms  %6.2f cmp/op  %6.2f levels/op  "
+              "%6.2f writes/op  (checksum %zu)\n", name, elapsed.count(),
+              stats.comparisons / double(stats.peak_size),
+              stats.sift_levels / double(stats.peak_size),
+              stats.index_writes / double(stats.peak_size),
+              static_cast<std::size_t>(checksum));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1u << 22;
+  std::printf("%zu keys\n", n);
+  workload work(n);
+  run<2, hhxx::flat_heap_layout>("flat, binary", work);
+  run<2, hhxx::blocked_heap_layout<9>>("blocked(9), binary", work);
+  run<4, hhxx::flat_heap_layout>("flat, 4-ary", work);
+  run<4, hhxx::blocked_heap_layout<5>>("blocked(5), 4-ary", work);
+  run<8, hhxx::flat_heap_layout>("flat, 8-ary", work);
+  run<8, hhxx::blocked_heap_layout<3>>("blocked(3), 8-ary", work);
+}
@@ -0,0 +1,122 @@
+// Copyright (c) 2016, Lingxi Li <lilingxi.cs@gmail.com>
+// All rights reserved.
+// Happy Hacking CXX Library (https://github.com/Lingxi-Li/Happy_Hacking_CXX)
+
+// Compares `radix_heap` with `mutable_priority_heap` running Dijkstra on a
+// road-network-shaped graph, i.e., a sparse near-planar grid with a few long
+// shortcuts standing in for highways. Build in release mode.
+// Usage: bench_radix_heap [grid side length]
+
+#include <hhxx/mutable_heap.hpp>
+#include <hhxx/radix_heap.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+// compressed sparse row graph
+struct graph {
+  explicit graph(std::size_t side) {
+    auto n = side * side;
+    std::mt19937 rand(static_cast<std::mt19937::result_type>(side));
+    std::uniform_int_distribution<std::uint32_t> local(100, 1000);
+    std::uniform_int_distribution<std::size_t> node(0, n - 1);
+    std::vector<std::vector<std::pair<std::size_t, std::uint32_t>>> adj(n);
+    auto connect = [&adj](std::size_t u, std::size_t v, std::uint32_t w) {
+      adj[u].emplace_back(v, w);
+      adj[v].emplace_back(u, w);
+    };
+    for (std::size_t r = 0; r < side; ++r) {
+      for (std::size_t c = 0; c < side; ++c) {
+        auto u = r * side + c;
+        if (c + 1 < side) connect(u, u + 1, local(rand));
+        if (r + 1 < side) connect(u, u + side, local(rand));
+      }
+    }
+    for (std::size_t i = 0; i < n / 100; ++i) {
+      auto u = node(rand);
+      auto v = node(rand);
+      // highways are faster per distance than local roads
+      auto dr = static_cast<long>(u / side) - static_cast<long>(v / side);
+      auto dc = static_cast<long>(u % side) - static_cast<long>(v % side);
+      connect(u, v, static_cast<std::uint32_t>(50 * (std::labs(dr) +
+                                                     std::labs(dc))));
+    }
+    first.push_back(0);
+    for (const auto& edges : adj) {
+      for (const auto& e : edges) {
+        target.push_back(e.first);
+        weight.push_back(e.second);
+      }
+      first.push_back(target.size());
+    }
+  }
+  std::size_t size() const {
+    return first.size() - 1;
+  }
+  std::vector<std::size_t> first;
+  std::vector<std::size_t> target;
+  std::vector<std::uint32_t> weight;
+};
+
+template <class Heap>
+void dijkstra(const char* name, const graph& g, Heap& heap,
+              std::vector<std::uint64_t>& dist) {
+  auto inf = std::numeric_limits<std::uint64_t>::max();
+  dist.assign(g.size(), inf);
+  heap.reserve(g.size());
+  auto start = std::chrono::steady_clock::now();
+  dist[0] = 0;
+  heap.push(0, 0);
+  while (! heap.empty()) {
+    auto u = heap.pop();
+    for (auto i = g.first[u]; i < g.first[u + 1]; ++i) {
+      auto v = g.target[i];
+      auto d = dist[u] + g.weight[i];
+      if (d < dist[v]) {
+        dist[v] = d;
+        heap.push(v, d);
+      }
+    }
+  }
+  auto stop = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = stop - start;
+  std::uint64_t checksum = 0;
+  for (auto d : dist) {
+    checksum += d;
+  }
+  std::printf("%-32s %10.1f ms  (checksum %llu)\n", name, elapsed.count(),
+              static_cast<unsigned long long>(checksum));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::size_t side = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000;
+  graph g(side);
+  std::printf("%zu nodes, %zu arcs\n", g.size(), g.target.size());
+  std::vector<std::uint64_t> dist;
+  {
+    hhxx::mutable_priority_heap<std::uint64_t, std::greater<std::uint64_t>,
+                                hhxx::dense_pos_index> heap;
+    dijkstra("mutable_priority_heap, binary", g, heap, dist);
+  }
+  {
+    hhxx::mutable_priority_heap<std::uint64_t, std::greater<std::uint64_t>,
+                                hhxx::dense_pos_index, 4> heap;
+    dijkstra("mutable_priority_heap, 4-ary", g, heap, dist);
+  }
+  {
+    hhxx::radix_heap<std::uint64_t, hhxx::dense_pos_index> heap;
+    dijkstra("radix_heap", g, heap, dist);
+  }
+}
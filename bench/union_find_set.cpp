@@ -0,0 +1,121 @@
+// Copyright (c) 2016, Lingxi Li <lilingxi.cs@gmail.com>
+// All rights reserved.
+// Happy Hacking CXX Library (https://github.com/Lingxi-Li/Happy_Hacking_CXX)
+
+// Compares union-find set variants on connected components of a random graph.
+// The concurrent variant, `connected_components()`, and dense label export run
+// with 1, 2, 4, ... up to the number of hardware threads. Build in release
+// mode.
+// Usage: bench_union_find_set [number of vertices] [edges per vertex]
+
+#include <hhxx/union_find_set.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <chrono>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using edge = std::pair<std::uintptr_t, std::uintptr_t>;
+
+// Unites the ends of all edges, then finds all vertices.
+template <class UnionFindSet>
+void run(const char* name, UnionFindSet ufset,
+         const std::vector<edge>& edges, std::size_t n) {
+  auto start = std::chrono::steady_clock::now();
+  for (const auto& e : edges) {
+    ufset.unite(e.first, e.second);
+  }
+  std::uintptr_t checksum = 0;
+  for (std::uintptr_t key = 0; key < n; ++key) {
+    checksum += ufset.find(key);
+  }
+  auto stop = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = stop - start;
+  std::printf("%-24s %10.1f ms  (checksum %zu)\n", name, elapsed.count(),
+              static_cast<std::size_t>(checksum));
+}
+
+// Same as above, but with edges sharded across `num_threads` threads.
+void run_concurrent(const char* name, std::size_t num_threads,
+                    const std::vector<edge>& edges, std::size_t n) {
+  hhxx::concurrent_union_find_set ufset(n);
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      auto first = edges.size() * t / num_threads;
+      auto last = edges.size() * (t + 1) / num_threads;
+      for (auto i = first; i < last; ++i) {
+        ufset.unite(edges[i].first, edges[i].second);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::uintptr_t checksum = 0;
+  for (std::uintptr_t key = 0; key < n; ++key) {
+    checksum += ufset.find(key);
+  }
+  auto stop = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = stop - start;
+  std::printf("%-16s %2zu threads %10.1f ms  (checksum %zu)\n", name,
+              num_threads, elapsed.count(), static_cast<std::size_t>(checksum));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1u << 22;
+  std::size_t d = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+  std::printf("%zu vertices, %zu edges\n", n, n * d);
+  std::mt19937_64 rand(n);
+  std::vector<edge> edges(n * d);
+  for (auto& e : edges) {
+    e.first = rand() % n;
+    e.second = rand() % n;
+  }
+  run("union_find_set", hhxx::union_find_set{}, edges, n);
+  run("dense_union_find_set", hhxx::dense_union_find_set(n), edges, n);
+  run("compact_union_find_set", hhxx::compact_union_find_set(n), edges, n);
+  run("flat_union_find_set", hhxx::flat_union_find_set(n), edges, n);
+  // roots differ, so checksums differ from the above
+  std::size_t max_threads = std::thread::hardware_concurrency();
+  for (std::size_t t = 1; t <= max_threads; t *= 2) {
+    run_concurrent("concurrent", t, edges, n);
+  }
+  for (std::size_t t = 1; t <= max_threads; t *= 2) {
+    auto start = std::chrono::steady_clock::now();
+    auto labels = hhxx::connected_components(edges.begin(), edges.end(), n, t);
+    auto stop = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = stop - start;
+    std::uintptr_t checksum = 0;
+    for (auto label : labels) {
+      checksum += label;
+    }
+    std::printf("%-16s %2zu threads %10.1f ms  (checksum %zu)\n",
+                "components", t, elapsed.count(),
+                static_cast<std::size_t>(checksum));
+  }
+  hhxx::dense_union_find_set dense(n);
+  for (const auto& e : edges) {
+    dense.unite(e.first, e.second);
+  }
+  std::vector<std::uintptr_t> labels(n);
+  for (std::size_t t = 1; t <= max_threads; t *= 2) {
+    auto start = std::chrono::steady_clock::now();
+    auto k = dense.export_labels(labels.begin(), t);
+    auto stop = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = stop - start;
+    std::printf("%-16s %2zu threads %10.1f ms  (%zu sets)\n",
+                "export_labels", t, elapsed.count(), k);
+  }
+}
@@ -6,10 +6,14 @@
 #include "hhxx/algorithm.hpp"
 #include "hhxx/bit.hpp"
 #include "hhxx/functional.hpp"
+#include "hhxx/lfu_cache.hpp"
+#include "hhxx/loser_tree.hpp"
 #include "hhxx/macro.hpp"
 #include "hhxx/meta.hpp"
+#include "hhxx/multi_queue.hpp"
 #include "hhxx/multi_view.hpp"
 #include "hhxx/mutable_heap.hpp"
+#include "hhxx/radix_heap.hpp"
 #include "hhxx/scope_guard.hpp"
 #include "hhxx/string.hpp"
 #include "hhxx/union_find_set.hpp"
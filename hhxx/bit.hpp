@@ -6,6 +6,7 @@
 #define HHXX_BIT_HPP_
 
 #include <climits>
+#include <cstdint>
 
 #include <bitset>
 #include <type_traits>
@@ -97,6 +98,21 @@ unsigned num_bits_set(T x) {
   return static_cast<unsigned>(std::bitset<num_bits<T>()>(x).count());
 }
 
+namespace detail {
+
+// Mixes bits of `x`, so that all of them affect the low bits. Keys are often
+// aligned addresses, whose low bits are all zero, so hash tables and shards
+// reducing keys by masking or modulo should mix them first. Uses the
+// finalizer of MurmurHash3, short of its last round.
+inline std::uint64_t mix_bits(std::uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  return x;
+}
+
+} // namespace detail
+
 } // namespace hhxx
 
 #endif // HHXX_BIT_HPP_
@@ -0,0 +1,209 @@
+// Copyright (c) 2016, Lingxi Li <lilingxi.cs@gmail.com>
+// All rights reserved.
+// Happy Hacking CXX Library (https://github.com/Lingxi-Li/Happy_Hacking_CXX)
+
+#ifndef HHXX_LFU_CACHE_HPP_
+#define HHXX_LFU_CACHE_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <utility>
+#include <vector>
+
+#include "hhxx/mutable_heap.hpp"
+
+namespace hhxx {
+
+/// Bounded cache that evicts the least frequently used entry first. Entries map
+/// keys of type `std::uintptr_t` to values of type `Value`. Each entry has a
+/// score, which starts at one and is bumped on each access, and a charge, which
+/// counts against the capacity. With unit charges, the capacity is the number
+/// of entries; with sizes in bytes as charges, it's a byte budget. Among
+/// entries of the same score, the least recently used is evicted first.
+/// Entries live in a `mutable_priority_heap` ordered by score. The heap's
+/// position index is the only key lookup structure, and values are stored in
+/// a slab indexed from the heap slots, so `get()` and `put()` take `O(log(n))`
+/// time with one index lookup. `PosIndex` is the same as that of
+/// `mutable_heap`. `Value` should be default constructible; values of evicted
+/// entries are reset to `Value{}` to release their resources.
+template <class Value, class PosIndex = hash_pos_index>
+class lfu_cache {
+public:
+  using key_type = std::uintptr_t;
+  using value_type = Value;
+  using score_type = std::uint64_t;
+
+  /// Constructs an empty cache whose entries total charges no more than
+  /// `capacity`.
+  explicit lfu_cache(std::size_t capacity)
+      : capacity_(capacity) {
+    // nop
+  }
+
+  /// Returns pointer to value of `key`, and bumps its score. Returns null if
+  /// `key` is not cached.
+  value_type* get(key_type key) {
+    auto meta = heap_.find_priority(key);
+    if (! meta) return nullptr;
+    auto slot = meta->slot;
+    heap_.decrease(key, bumped(*meta));
+    return &values_[slot];
+  }
+
+  /// Returns pointer to value of `key` without bumping its score. Returns null
+  /// if `key` is not cached.
+  const value_type* peek(key_type key) const {
+    auto meta = heap_.find_priority(key);
+    return meta ? &values_[meta->slot] : nullptr;
+  }
+
+  /// Caches `value` for `key` with charge `charge`. If `key` is already
+  /// cached, replaces its value and charge, and bumps its score. Then evicts
+  /// entries of the lowest scores until the total charge fits the capacity.
+  /// If `charge` alone exceeds the capacity, leaves the cache unchanged
+  /// instead, and returns `false`. Returns `true` otherwise.
+  bool put(key_type key, value_type value, std::size_t charge = 1) {
+    if (charge > capacity_) return false;
+    auto meta = heap_.find_priority(key);
+    if (meta) {
+      auto next = bumped(*meta);
+      charge_ = charge_ - next.charge + charge;
+      next.charge = charge;
+      values_[next.slot] = std::move(value);
+      heap_.decrease(key, next);
+    }
+    else {
+      auto slot = allocate(std::move(value));
+      charge_ += charge;
+      heap_.push(key, entry{1, ++tick_, charge, slot});
+    }
+    while (charge_ > capacity_) {
+      evict();
+    }
+    return true;
+  }
+
+  /// Removes `key`. Returns whether `key` was cached.
+  bool erase(key_type key) {
+    auto meta = heap_.find_priority(key);
+    if (! meta) return false;
+    auto charge = meta->charge;
+    release(meta->slot);
+    heap_.erase(key);
+    charge_ -= charge;
+    return true;
+  }
+
+  /// Returns whether `key` is cached.
+  bool contains(key_type key) const {
+    return heap_.contains(key);
+  }
+
+  /// Returns score of `key`, which should be cached.
+  score_type score(key_type key) const {
+    auto meta = heap_.find_priority(key);
+    assert(meta);
+    return meta->score;
+  }
+
+  /// Returns the key to be evicted next. The cache should be non-empty.
+  key_type victim() const {
+    return heap_.top();
+  }
+
+  /// Evicts all entries.
+  void clear() {
+    heap_.clear();
+    values_.clear();
+    free_.clear();
+    charge_ = 0;
+  }
+
+  /// Returns the number of entries.
+  std::size_t size() const {
+    return heap_.size();
+  }
+
+  /// Returns whether the cache is empty.
+  bool empty() const {
+    return heap_.empty();
+  }
+
+  /// Returns the total charge of entries.
+  std::size_t charge() const {
+    return charge_;
+  }
+
+  /// Returns the capacity.
+  std::size_t capacity() const {
+    return capacity_;
+  }
+
+  /// Changes the capacity to `capacity`, evicting entries as necessary.
+  void set_capacity(std::size_t capacity) {
+    capacity_ = capacity;
+    while (charge_ > capacity_) {
+      evict();
+    }
+  }
+
+private:
+  // Priority of an entry in the heap.
+  struct entry {
+    score_type score;
+    std::uint64_t tick;  // time of last access, to break ties
+    std::size_t charge;
+    std::size_t slot;    // index into `values_`
+  };
+
+  // Higher priority for lower score, then older access.
+  struct evict_first {
+    bool operator ()(const entry& a, const entry& b) const {
+      return b.score < a.score || (b.score == a.score && b.tick < a.tick);
+    }
+  };
+
+  using heap_type = mutable_priority_heap<entry, evict_first, PosIndex>;
+
+  entry bumped(entry meta) {
+    ++meta.score;
+    meta.tick = ++tick_;
+    return meta;
+  }
+
+  std::size_t allocate(value_type value) {
+    if (free_.empty()) {
+      values_.push_back(std::move(value));
+      return values_.size() - 1;
+    }
+    auto slot = free_.back();
+    free_.pop_back();
+    values_[slot] = std::move(value);
+    return slot;
+  }
+
+  void release(std::size_t slot) {
+    values_[slot] = value_type{};
+    free_.push_back(slot);
+  }
+
+  void evict() {
+    const auto& meta = heap_.top_priority();
+    charge_ -= meta.charge;
+    release(meta.slot);
+    heap_.pop();
+  }
+
+  heap_type heap_;
+  std::vector<value_type> values_;
+  std::vector<std::size_t> free_;
+  std::size_t capacity_;
+  std::size_t charge_ = 0;
+  std::uint64_t tick_ = 0;
+};
+
+} // namespace hhxx
+
+#endif // HHXX_LFU_CACHE_HPP_
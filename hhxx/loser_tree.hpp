@@ -0,0 +1,174 @@
+// Copyright (c) 2016, Lingxi Li <lilingxi.cs@gmail.com>
+// All rights reserved.
+// Happy Hacking CXX Library (https://github.com/Lingxi-Li/Happy_Hacking_CXX)
+
+#ifndef HHXX_LOSER_TREE_HPP_
+#define HHXX_LOSER_TREE_HPP_
+
+#include <cassert>
+#include <cstddef>
+
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace hhxx {
+
+/// Tournament tree of losers over `k` sorted runs, each being a range of
+/// iterator type `It`. Yields elements of all runs in ascending order, as
+/// defined by less-than comparator type `Less`. Elements of different runs that
+/// compare equal are yielded in the order of the runs, so merging is stable.
+/// Each internal node holds the loser of the match played there. Taking an
+/// element only replays the matches on the path from its leaf to the root,
+/// which costs one comparison per level, `ceil(log2(k))` in total. Nodes are
+/// laid out in one flat array, level by level. The current element of each
+/// run is cached in another, so matches don't chase run iterators.
+template <class It,
+          class Less = std::less<typename std::iterator_traits<It>::value_type>>
+class loser_tree {
+public:
+  using iterator = It;
+  using value_type = typename std::iterator_traits<It>::value_type;
+
+  /// Constructs a loser tree over the runs in `[first, last)` using `less` as
+  /// the less-than comparator. Each run is a range with `begin()` and `end()`
+  /// convertible to `It`, and should be sorted with respect to `less`. Runs
+  /// are referenced, not copied, and should outlive the tree.
+  template <class ForwardIt>
+  loser_tree(ForwardIt first, ForwardIt last, Less less = Less{})
+      : less_(std::move(less)) {
+    using std::begin;
+    using std::end;
+    for (; first != last; ++first) {
+      cur_.push_back(begin(*first));
+      end_.push_back(end(*first));
+    }
+    build();
+  }
+
+  /// Returns whether all runs are exhausted.
+  bool empty() const {
+    return tree_.empty() || done_[tree_[0]];
+  }
+
+  /// Returns the smallest remaining element.
+  const value_type& top() const {
+    assert(! empty());
+    return head_[tree_[0]];
+  }
+
+  /// Returns index of the run `top()` comes from.
+  std::size_t top_run() const {
+    assert(! empty());
+    return tree_[0];
+  }
+
+  /// Takes the smallest remaining element, and advances its run.
+  void pop() {
+    assert(! empty());
+    auto winner = tree_[0];
+    advance(winner);
+    for (auto child = winner + tree_.size(); child > 1; child /= 2) {
+      // select by masking rather than branching, for match outcomes are
+      // unpredictable
+      auto& loser = tree_[child / 2];
+      auto swap = beats(loser, winner, child % 2 == 0);
+      auto mask = -static_cast<std::size_t>(swap);
+      auto next = (loser & mask) | (winner & ~mask);
+      loser ^= winner ^ next;
+      winner = next;
+    }
+    tree_[0] = winner;
+  }
+
+  /// Returns the number of runs.
+  std::size_t num_runs() const {
+    return cur_.size();
+  }
+
+private:
+  // Returns whether run `a` wins a match against run `b`, where `b_left`
+  // tells whether `b` comes from the left subtree. An exhausted run loses to
+  // everything. Ties go to the left, i.e., the run of lower index, which costs
+  // no extra comparison.
+  bool beats(std::size_t a, std::size_t b, bool b_left) {
+    if (done_[a]) return false;
+    if (done_[b]) return true;
+    auto mask = -static_cast<std::size_t>(b_left);
+    auto x = (a & mask) | (b & ~mask);
+    auto y = a ^ b ^ x;
+    return less_(head_[x], head_[y]) != ! b_left;
+  }
+
+  // Loads the current element of `run` into `head_`, if any.
+  void load(std::size_t run) {
+    done_[run] = cur_[run] == end_[run];
+    if (! done_[run]) head_[run] = *cur_[run];
+  }
+
+  void advance(std::size_t run) {
+    ++cur_[run];
+    load(run);
+  }
+
+  // Plays the initial tournament bottom-up. The number of leaves is rounded up
+  // to a power of two `n` with exhausted dummy runs, so runs of the left
+  // subtree of a node always precede those of the right. Leaf of run `i` sits
+  // at implicit position `n + i`, and node `p` has children `2p` and `2p + 1`.
+  // `tree_[0]` holds the overall winner.
+  void build() {
+    auto k = cur_.size();
+    if (k == 0) return;
+    std::size_t n = 1;
+    while (n < k) {
+      n *= 2;
+    }
+    head_.resize(n);
+    done_.assign(n, true);
+    for (std::size_t run = 0; run < k; ++run) {
+      load(run);
+    }
+    tree_.resize(n);
+    std::vector<std::size_t> winners(n);
+    auto winner_of = [&](std::size_t node) {
+      return node < n ? winners[node] : node - n;
+    };
+    for (auto node = n - 1; node > 0; --node) {
+      auto a = winner_of(2 * node);
+      auto b = winner_of(2 * node + 1);
+      if (! beats(a, b, false)) std::swap(a, b);
+      winners[node] = a;
+      tree_[node] = b;
+    }
+    tree_[0] = winner_of(1);
+  }
+
+  Less less_;
+  std::vector<It> cur_;
+  std::vector<It> end_;
+  // current element of each run, kept contiguous for matches to compare
+  std::vector<value_type> head_;
+  std::vector<char> done_;
+  std::vector<std::size_t> tree_;
+};
+
+/// Merges the sorted runs in `[first, last)` into the range beginning at `out`
+/// using `less` as the less-than comparator. Each run is a range with `begin()`
+/// and `end()`. The merge is stable. Returns end of the output range.
+template <class ForwardIt, class OutputIt, class Less = std::less<>>
+OutputIt kway_merge(ForwardIt first, ForwardIt last, OutputIt out,
+                    Less less = Less{}) {
+  using std::begin;
+  using run_iterator = decltype(begin(*first));
+  loser_tree<run_iterator, Less> tree(first, last, std::move(less));
+  while (! tree.empty()) {
+    *out++ = tree.top();
+    tree.pop();
+  }
+  return out;
+}
+
+} // namespace hhxx
+
+#endif // HHXX_LOSER_TREE_HPP_
@@ -0,0 +1,161 @@
+// Copyright (c) 2016, Lingxi Li <lilingxi.cs@gmail.com>
+// All rights reserved.
+// Happy Hacking CXX Library (https://github.com/Lingxi-Li/Happy_Hacking_CXX)
+
+#ifndef HHXX_MULTI_QUEUE_HPP_
+#define HHXX_MULTI_QUEUE_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+
+#include "hhxx/algorithm.hpp"
+#include "hhxx/bit.hpp"
+#include "hhxx/mutable_heap.hpp"
+
+namespace hhxx {
+
+/// Relaxed concurrent max-priority queue with mutable priorities, known as
+/// MultiQueue. Keys are distributed over `num_shards` shards, each being a
+/// `mutable_priority_heap` guarded by its own mutex. A key always lives in the
+/// same shard, determined by hashing the key, so re-prioritizing a key locks
+/// only that shard. `try_pop()` takes the better of the roots of two random
+/// shards. The key taken is of high, but not necessarily the highest, priority.
+/// Throughput scales with the number of threads, as long as there are a few
+/// times more shards than threads.
+template <class Priority, class Less = std::less<Priority>,
+          std::size_t arity = 2>
+class multi_queue {
+public:
+  using key_type = std::uintptr_t;
+  using priority_type = Priority;
+  using heap_type =
+    mutable_priority_heap<Priority, Less, hash_pos_index, arity>;
+
+  /// Constructs a multi queue of `num_shards` shards using `less` as the
+  /// less-than comparator of priorities. `num_shards` should be at least 2.
+  explicit multi_queue(std::size_t num_shards, Less less = Less{})
+      : num_shards_(num_shards),
+        shards_(new shard[num_shards]),
+        less_(less) {
+    assert(num_shards >= 2);
+    for (std::size_t i = 0; i < num_shards; ++i) {
+      shards_[i].heap = heap_type(less);
+    }
+  }
+
+  /// Adds `key` with `priority`. If `key` is already in the queue, changes its
+  /// priority to `priority`.
+  void push(key_type key, priority_type priority) {
+    auto& target = shard_of(key);
+    std::lock_guard<std::mutex> lock(target.mutex);
+    if (! target.heap.contains(key)) {
+      size_.fetch_add(1, std::memory_order_relaxed);
+    }
+    target.heap.push(key, std::move(priority));
+  }
+
+  /// Removes `key`. Returns whether `key` was in the queue.
+  bool erase(key_type key) {
+    auto& target = shard_of(key);
+    std::lock_guard<std::mutex> lock(target.mutex);
+    if (! target.heap.erase(key)) return false;
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /// Takes a key of high priority, and stores it to `key` and its priority to
+  /// `priority`. Returns `false` if the queue is found empty.
+  bool try_pop(key_type& key, priority_type& priority) {
+    for (std::size_t attempt = 0; attempt < num_shards_; ++attempt) {
+      auto i = random_shard(num_shards_);
+      auto j = random_shard(num_shards_ - 1);
+      if (j >= i) ++j;
+      std::unique_lock<std::mutex> lock_i(shards_[i].mutex, std::try_to_lock);
+      if (! lock_i) continue;
+      std::unique_lock<std::mutex> lock_j(shards_[j].mutex, std::try_to_lock);
+      if (! lock_j) continue;
+      auto& heap_i = shards_[i].heap;
+      auto& heap_j = shards_[j].heap;
+      if (heap_i.empty() && heap_j.empty()) continue;
+      auto& heap = heap_i.empty() || (! heap_j.empty()
+                   && less_(heap_i.top_priority(), heap_j.top_priority()))
+                 ? heap_j : heap_i;
+      take(heap, key, priority);
+      return true;
+    }
+    // contended or sparse; sweep through all shards
+    for (std::size_t i = 0; i < num_shards_; ++i) {
+      std::lock_guard<std::mutex> lock(shards_[i].mutex);
+      if (shards_[i].heap.empty()) continue;
+      take(shards_[i].heap, key, priority);
+      return true;
+    }
+    return false;
+  }
+
+  /// Same as above, but discards the priority.
+  bool try_pop(key_type& key) {
+    priority_type priority;
+    return try_pop(key, priority);
+  }
+
+  /// Returns the number of keys in the queue. Exact only when no other thread
+  /// is modifying the queue.
+  std::size_t size() const {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  /// Returns whether the queue is empty. Same caveat as `size()`.
+  bool empty() const {
+    return size() == 0;
+  }
+
+  /// Returns the number of shards.
+  std::size_t num_shards() const {
+    return num_shards_;
+  }
+
+private:
+  // padded to keep shards on different cache lines
+  struct shard {
+    std::mutex mutex;
+    heap_type heap;
+    char padding[64];
+  };
+
+  shard& shard_of(key_type key) {
+    return shards_[detail::mix_bits(key) % num_shards_];
+  }
+
+  // Returns a random shard index in `[0, n)`.
+  static std::size_t random_shard(std::size_t n) {
+    using seed_type = std::minstd_rand::result_type;
+    thread_local std::minstd_rand rand(static_cast<seed_type>(
+      tick_count() ^ std::hash<std::thread::id>{}(std::this_thread::get_id())));
+    return std::uniform_int_distribution<std::size_t>(0, n - 1)(rand);
+  }
+
+  void take(heap_type& heap, key_type& key, priority_type& priority) {
+    priority = heap.top_priority();
+    key = heap.pop();
+    size_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  std::size_t num_shards_;
+  std::unique_ptr<shard[]> shards_;
+  Less less_;
+  std::atomic<std::size_t> size_{0};
+};
+
+} // namespace hhxx
+
+#endif // HHXX_MULTI_QUEUE_HPP_
@@ -7,35 +7,251 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 
 #include <algorithm>
+#include <array>
 #include <initializer_list>
 #include <tuple>
 #include <type_traits>
 #include <utility>
 
+#include "hhxx/meta.hpp"
+
 namespace hhxx {
 
-/// Provides a multi-dimensional view of a one-dimensional linear range. The
-/// linear range can then be accessed in a multi-dimensional fashion. `Iterator`
-/// specifies the iterator type used to denote the linear range.
+/// Subview specifier that keeps the whole of a dimension.
+struct full_extent_t {};
+constexpr full_extent_t full_extent{};
 
-template <typename Iterator>
-class multi_view {
+/// Subview specifier that keeps indices `first, first + stride, ...` below
+/// `last` of a dimension.
+struct slice {
+  std::size_t first;
+  std::size_t last;
+  std::size_t stride = 1;
+};
+
+template <typename Iterator, std::size_t rank>
+class strided_multi_view;
+
+namespace detail {
+
+template <std::size_t... extents>
+constexpr std::size_t static_extent(std::size_t dim) {
+  constexpr std::size_t exts[] = { extents... };
+  return exts[dim];
+}
+
+// Number of dimensions kept by subview specifiers `Specs...`. Indices drop
+// theirs.
+template <typename... Specs>
+constexpr std::size_t subview_rank() {
+  constexpr bool kept[] = { ! std::is_integral<Specs>::value..., false };
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < sizeof...(Specs); ++i) {
+    count += kept[i];
+  }
+  return count;
+}
+
+// Applies subview specifier `spec` to a dimension of extent `ext` and stride
+// `stride`. Accumulates the offset of the subview to `offset`, and appends the
+// kept dimension, if any, to `exts` and `strides` at `rank`.
+template <typename T>
+void apply_subview_spec(T index, std::size_t ext, std::size_t stride,
+                        std::size_t& offset, std::size_t*, std::size_t*,
+                        std::size_t&) {
+  static_assert(std::is_integral<T>::value, "");
+  assert(index >= 0 && static_cast<std::size_t>(index) < ext);
+  offset += static_cast<std::size_t>(index) * stride;
+}
+
+inline void apply_subview_spec(full_extent_t, std::size_t ext,
+                               std::size_t stride, std::size_t&,
+                               std::size_t* exts, std::size_t* strides,
+                               std::size_t& rank) {
+  exts[rank] = ext;
+  strides[rank++] = stride;
+}
+
+inline void apply_subview_spec(slice spec, std::size_t ext,
+                               std::size_t stride, std::size_t& offset,
+                               std::size_t* exts, std::size_t* strides,
+                               std::size_t& rank) {
+  assert(spec.first <= spec.last && spec.last <= ext && spec.stride > 0);
+  offset += spec.first * stride;
+  exts[rank] = (spec.last - spec.first + spec.stride - 1) / spec.stride;
+  strides[rank++] = stride * spec.stride;
+}
+
+// Makes the subview at `specs...` of the view beginning at `base`, whose
+// dimensions have extents `exts` and strides `strides`.
+template <typename Iterator, typename... Specs>
+auto make_subview(Iterator base, const std::size_t* exts,
+                  const std::size_t* strides, Specs... specs) {
+  constexpr auto rank = subview_rank<Specs...>();
+  std::array<std::size_t, rank> sub_exts{};
+  std::array<std::size_t, rank> sub_strides{};
+  std::size_t offset = 0;
+  std::size_t dim = 0;
+  std::size_t sub_rank = 0;
+  using expand = int[];
+  (void)expand{ 0, (apply_subview_spec(specs, exts[dim], strides[dim], offset,
+                                       sub_exts.data(), sub_strides.data(),
+                                       sub_rank), ++dim, 0)... };
+  return strided_multi_view<Iterator, rank>(base + offset, sub_exts,
+                                            sub_strides);
+}
+
+} // namespace detail
+
+/// Multi-dimensional view of a one-dimensional linear range with arbitrary
+/// strides, such as subviews of other views. The number of dimensions is fixed
+/// at compile time as `rank`. Elements of a sub-object are not contiguous in
+/// general, so there is no `end()`. `Iterator` should be random access.
+template <typename Iterator, std::size_t rank>
+class strided_multi_view {
 public:
-  /// Maximum number of dimensions supported.
-  static constexpr std::size_t max_dim = 10;
+  /// `base` is an iterator to the first element. `extents` and `strides`
+  /// specify the extent and stride of each dimension.
+  strided_multi_view(Iterator base,
+                     const std::array<std::size_t, rank>& extents,
+                     const std::array<std::size_t, rank>& strides)
+      : base_(base),
+        extents_(extents),
+        strides_(strides) {
+    // nop
+  }
 
-  /// `base` is an iterator denoting a one-dimensional linear range. `extents...`
-  /// specifies the extent of each dimension of the multi-dimensional view.
-  /// So, `sizeof...(extents)` is the number of dimensions.
+  /// Returns the extent of dimension `dim`.
+  std::size_t extent(std::size_t dim) const {
+    return extents_[dim];
+  }
+
+  /// Returns the stride of dimension `dim`.
+  std::size_t stride(std::size_t dim) const {
+    return strides_[dim];
+  }
+
+  /// Returns the number of elements.
+  std::size_t size() const {
+    std::size_t acc = 1;
+    for (auto ext : extents_) {
+      acc *= ext;
+    }
+    return acc;
+  }
+
+  /// Returns an iterator to the element at `indices...`, with missing indices
+  /// zero filled.
   template <typename... Ts>
-  multi_view(Iterator base, Ts... extents)
-      : base_(base) {
-    constexpr auto n = sizeof...(extents);
-    static_assert(0 < n && n <= max_dim, "");
-    auto init_list = { extents... };
-    std::copy(init_list.begin(), init_list.end(), steps_);
+  auto begin(Ts... indices) const {
+    static_assert(sizeof...(indices) <= rank, "");
+    // zero filled, with one more to be non-empty
+    const std::size_t idxes[rank + 1] = {
+      static_cast<std::size_t>(indices)...
+    };
+    return base_ + offset_of(std::make_index_sequence<rank>{}, idxes);
+  }
+
+  /// Accesses the element at `indices...`, with missing indices zero filled.
+  template <typename... Ts>
+  auto operator ()(Ts... indices) const {
+    return *begin(indices...);
+  }
+
+  /// Returns a view of the elements picked by `specs...` along each
+  /// dimension. Each specifier is an index, which drops the dimension,
+  /// `full_extent`, or a `slice`. Refers to the same range with no copying.
+  template <typename... Specs>
+  auto subview(Specs... specs) const {
+    static_assert(sizeof...(specs) == rank, "");
+    return detail::make_subview(base_, extents_.data(), strides_.data(),
+                                specs...);
+  }
+
+private:
+  template <std::size_t... dims>
+  std::size_t offset_of(std::index_sequence<dims...>,
+                        const std::size_t* idxes) const {
+    std::size_t offset = 0;
+    using expand = int[];
+    (void)expand{ 0, (offset += idxes[dims] * strides_[dims], 0)... };
+    return offset;
+  }
+
+  Iterator base_;
+  std::array<std::size_t, rank> extents_;
+  std::array<std::size_t, rank> strides_;
+};
+
+namespace detail {
+
+constexpr std::size_t multi_view_max_dim = 10;
+
+// Copies `extents...` to `exts`, and returns their number.
+template <typename... Ts>
+std::size_t copy_extents(std::size_t* exts, Ts... extents) {
+  constexpr auto n = sizeof...(extents);
+  static_assert(0 < n && n <= multi_view_max_dim, "");
+  auto init_list = { extents... };
+  std::copy(init_list.begin(), init_list.end(), exts);
+  return n;
+}
+
+// Tells whether `T` is a layout policy of `multi_view`, which all have
+// `is_strided`.
+template <typename T, typename = void>
+struct is_multi_view_layout : std::false_type {};
+
+template <typename T>
+struct is_multi_view_layout<
+  T, enable_if_well_formed_t<decltype(T::is_strided)>> : std::true_type {};
+
+// Spreads the low 32 bits of `x` to the even bits.
+inline std::uint64_t spread_bits_by_1(std::uint64_t x) {
+  x &= 0xffffffffull;
+  x = (x | x << 16) & 0x0000ffff0000ffffull;
+  x = (x | x << 8) & 0x00ff00ff00ff00ffull;
+  x = (x | x << 4) & 0x0f0f0f0f0f0f0f0full;
+  x = (x | x << 2) & 0x3333333333333333ull;
+  x = (x | x << 1) & 0x5555555555555555ull;
+  return x;
+}
+
+// Spreads the low 21 bits of `x` to every third bit.
+inline std::uint64_t spread_bits_by_2(std::uint64_t x) {
+  x &= 0x1fffffull;
+  x = (x | x << 32) & 0x001f00000000ffffull;
+  x = (x | x << 16) & 0x001f0000ff0000ffull;
+  x = (x | x << 8) & 0x100f00f00f00f00full;
+  x = (x | x << 4) & 0x10c30c30c30c30c3ull;
+  x = (x | x << 2) & 0x1249249249249249ull;
+  return x;
+}
+
+} // namespace detail
+
+/// Layout policies of `multi_view` map indices to offsets in the linear range.
+/// A layout is constructed from the extents, and provides
+/// - `span()`, the number of elements of the linear range spanned, which may
+///   exceed the number of elements for padding, and
+/// - `offset(idxes, n)`, the offset of the element at the `n` indices pointed
+///   to by `idxes`, with missing indices zero filled.
+/// Strided layouts also provide `rank()`, `extent(dim)`, and `stride(dim)`,
+/// and are marked by `is_strided`. Layouts where the sub-object at leading
+/// indices is contiguous are marked by `has_contiguous_subobjects`.
+
+/// Layout of C arrays, where the last index varies fastest.
+class row_major {
+public:
+  static constexpr bool is_strided = true;
+  static constexpr bool has_contiguous_subobjects = true;
+
+  template <typename... Ts>
+  explicit row_major(Ts... extents) {
+    auto n = detail::copy_extents(steps_, extents...);
     auto i = n - 1;
     std::size_t acc = 1;
     do {
@@ -46,6 +262,249 @@ public:
     num_elements_ = acc;
   }
 
+  std::size_t rank() const {
+    std::size_t n = 0;
+    while (steps_[n]) {
+      ++n;
+    }
+    return n;
+  }
+
+  std::size_t extent(std::size_t dim) const {
+    return (dim ? steps_[dim - 1] : num_elements_) / steps_[dim];
+  }
+
+  std::size_t stride(std::size_t dim) const {
+    return steps_[dim];
+  }
+
+  std::size_t span() const {
+    return num_elements_;
+  }
+
+  template <typename T>
+  std::size_t offset(const T* idxes, std::size_t n) const {
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < n && steps_[i]; ++i) {
+      assert(idxes[i] >= 0);
+      offset += idxes[i] * steps_[i];
+    }
+    return offset;
+  }
+
+private:
+  std::size_t steps_[detail::multi_view_max_dim + 1]{};
+  std::size_t num_elements_ = 0;
+};
+
+/// Layout of Fortran arrays, where the first index varies fastest.
+class column_major {
+public:
+  static constexpr bool is_strided = true;
+  static constexpr bool has_contiguous_subobjects = false;
+
+  template <typename... Ts>
+  explicit column_major(Ts... extents) {
+    rank_ = detail::copy_extents(steps_, extents...);
+    std::size_t acc = 1;
+    for (std::size_t i = 0; i < rank_; ++i) {
+      acc *= std::exchange(steps_[i], acc);
+    }
+    assert(acc);
+    num_elements_ = acc;
+  }
+
+  std::size_t rank() const {
+    return rank_;
+  }
+
+  std::size_t extent(std::size_t dim) const {
+    return (dim + 1 < rank_ ? steps_[dim + 1] : num_elements_) / steps_[dim];
+  }
+
+  std::size_t stride(std::size_t dim) const {
+    return steps_[dim];
+  }
+
+  std::size_t span() const {
+    return num_elements_;
+  }
+
+  template <typename T>
+  std::size_t offset(const T* idxes, std::size_t n) const {
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < n && i < rank_; ++i) {
+      assert(idxes[i] >= 0);
+      offset += idxes[i] * steps_[i];
+    }
+    return offset;
+  }
+
+private:
+  std::size_t steps_[detail::multi_view_max_dim]{};
+  std::size_t rank_ = 0;
+  std::size_t num_elements_ = 0;
+};
+
+/// Blocked layout of `sizeof...(tile)` dimensions, where tiles of extents
+/// `tile...` are laid out in row-major order, and so are elements in each
+/// tile. Extents are padded up to multiples of the tile extents. Neighbours
+/// in any dimension mostly share a tile, hence cache lines and pages. With
+/// tile extents as powers of two, divisions and remainders compile to shifts
+/// and masks.
+template <std::size_t... tile>
+class tiled {
+public:
+  static constexpr bool is_strided = false;
+  static constexpr bool has_contiguous_subobjects = false;
+
+  template <typename... Ts>
+  explicit tiled(Ts... extents) {
+    static_assert(sizeof...(extents) == rank, "");
+    std::size_t exts[rank];
+    detail::copy_extents(exts, extents...);
+    for (std::size_t i = 0; i < rank; ++i) {
+      tiles_[i] = (exts[i] + tile_extent(i) - 1) / tile_extent(i);
+    }
+  }
+
+  std::size_t span() const {
+    std::size_t acc = volume();
+    for (auto count : tiles_) {
+      acc *= count;
+    }
+    return acc;
+  }
+
+  template <typename T>
+  std::size_t offset(const T* idxes, std::size_t n) const {
+    std::size_t full[rank] = {};
+    for (std::size_t i = 0; i < n && i < rank; ++i) {
+      assert(idxes[i] >= 0);
+      full[i] = static_cast<std::size_t>(idxes[i]);
+    }
+    return offset_of(std::make_index_sequence<rank>{}, full);
+  }
+
+private:
+  static constexpr std::size_t rank = sizeof...(tile);
+
+  static constexpr std::size_t tile_extent(std::size_t dim) {
+    return detail::static_extent<tile...>(dim);
+  }
+
+  static constexpr std::size_t volume() {
+    std::size_t acc = 1;
+    for (std::size_t i = 0; i < rank; ++i) {
+      acc *= tile_extent(i);
+    }
+    return acc;
+  }
+
+  // Offset of the tile in Horner form, times tile volume, plus offset in the
+  // tile, with the pack expansion unrolled and tile extents as constants.
+  template <std::size_t... dims>
+  std::size_t offset_of(std::index_sequence<dims...>,
+                        const std::size_t* idxes) const {
+    std::size_t outer = 0;
+    std::size_t inner = 0;
+    using expand = int[];
+    (void)expand{ (outer = outer * tiles_[dims] + idxes[dims] /
+                           tile_extent(dims),
+                   inner = inner * tile_extent(dims) + idxes[dims] %
+                           tile_extent(dims), 0)... };
+    return outer * volume() + inner;
+  }
+
+  std::size_t tiles_[rank];
+};
+
+/// Z-order layout, where bits of indices are interleaved, the highest bit of
+/// the first index going first. Neighbours in any dimension are mostly close,
+/// recursively at every scale. Extents are padded up to a common power of two,
+/// so elongated shapes waste space. Bits are spread by shift-and-mask tricks
+/// for 2 and 3 dimensions, with up to 32 and 21 bits per index respectively,
+/// and one at a time for more dimensions.
+class morton {
+public:
+  static constexpr bool is_strided = false;
+  static constexpr bool has_contiguous_subobjects = false;
+
+  template <typename... Ts>
+  explicit morton(Ts... extents) {
+    std::size_t exts[detail::multi_view_max_dim];
+    rank_ = detail::copy_extents(exts, extents...);
+    auto max_ext = *std::max_element(exts, exts + rank_);
+    while ((std::size_t(1) << bits_) < max_ext) {
+      ++bits_;
+    }
+    assert(bits_ * rank_ < 64);
+  }
+
+  std::size_t span() const {
+    return std::size_t(1) << (bits_ * rank_);
+  }
+
+  template <typename T>
+  std::size_t offset(const T* idxes, std::size_t n) const {
+    std::uint64_t full[detail::multi_view_max_dim] = {};
+    for (std::size_t i = 0; i < n && i < rank_; ++i) {
+      assert(idxes[i] >= 0);
+      full[i] = static_cast<std::uint64_t>(idxes[i]);
+    }
+    if (rank_ == 2) {
+      return static_cast<std::size_t>(detail::spread_bits_by_1(full[1]) |
+                                      detail::spread_bits_by_1(full[0]) << 1);
+    }
+    if (rank_ == 3) {
+      return static_cast<std::size_t>(detail::spread_bits_by_2(full[2]) |
+                                      detail::spread_bits_by_2(full[1]) << 1 |
+                                      detail::spread_bits_by_2(full[0]) << 2);
+    }
+    std::uint64_t offset = 0;
+    for (std::size_t bit = 0; bit < bits_; ++bit) {
+      for (std::size_t i = 0; i < rank_; ++i) {
+        offset |= (full[i] >> bit & 1) << (bit * rank_ + rank_ - 1 - i);
+      }
+    }
+    return static_cast<std::size_t>(offset);
+  }
+
+private:
+  std::size_t rank_ = 0;
+  std::size_t bits_ = 0;
+};
+
+/// Provides a multi-dimensional view of a one-dimensional linear range. The
+/// linear range can then be accessed in a multi-dimensional fashion. `Iterator`
+/// specifies the iterator type used to denote the linear range. `Layout`
+/// specifies how indices map to the linear range, one of `row_major`,
+/// `column_major`, `tiled`, and `morton`. Except for `row_major`, sub-objects
+/// at leading indices are not contiguous, so `end()` is for the whole view
+/// only, and `begin(indices...)` is an iterator to the first element.
+
+template <typename Iterator, typename Layout = row_major>
+class multi_view {
+public:
+  /// Maximum number of dimensions supported.
+  static constexpr std::size_t max_dim = detail::multi_view_max_dim;
+
+  /// `base` is an iterator denoting a one-dimensional linear range. `extents...`
+  /// specifies the extent of each dimension of the multi-dimensional view.
+  /// So, `sizeof...(extents)` is the number of dimensions.
+  template <typename... Ts>
+  multi_view(Iterator base, Ts... extents)
+      : base_(base),
+        layout_(extents...) {
+    // nop
+  }
+
+  /// Returns the number of elements of the linear range the view spans,
+  /// including padding of the layout, if any.
+  std::size_t span() const {
+    return layout_.span();
+  }
+
   /// Returns a begin iterator of the sub-object at `indices...`. An empty set of
   /// `indices` returns a begin iterator of the multi-dimensional object itself.
 
@@ -56,13 +515,9 @@ public:
 
   template <typename... Ts>
   auto begin(Ts... indices) const {
-    auto idxes = std::begin({ indices... });
-    std::size_t offset = 0;
-    for (std::size_t i = 0; i < sizeof...(indices) && steps_[i]; ++i) {
-      assert(idxes[i] >= 0);
-      offset += idxes[i] * steps_[i];
-    }
-    return (base_ + offset);
+    // a named list, as the array of a temporary one dies with the statement
+    auto init_list = { indices... };
+    return base_ + layout_.offset(init_list.begin(), sizeof...(indices));
   }
 
   /// Returns an end iterator of the sub-object at `indices...`. An empty set of
@@ -70,11 +525,12 @@ public:
 
   template <typename... Ts>
   auto end() const {
-    return base_ + num_elements_;
+    return base_ + layout_.span();
   }
 
   template <typename... Ts>
   auto end(Ts... indices) const {
+    static_assert(Layout::has_contiguous_subobjects, "");
     return end_impl(std::index_sequence_for<Ts...>{}, indices...);
   }
 
@@ -85,6 +541,27 @@ public:
     return *begin(indices...);
   }
 
+  /// Returns a `strided_multi_view` of the elements picked by `specs...`, one
+  /// for each dimension. Each specifier is an index, which drops the
+  /// dimension, `full_extent`, or a `slice`. Refers to the same range with no
+  /// copying. For example, `subview(full_extent, 2)` is column 2 of a
+  /// two-dimensional view. `Layout` should be strided.
+  template <typename... Specs>
+  auto subview(Specs... specs) const {
+    static_assert(Layout::is_strided, "");
+    constexpr auto n = sizeof...(specs);
+    static_assert(0 < n && n <= max_dim, "");
+    // one specifier per dimension
+    assert(layout_.rank() == n);
+    std::size_t exts[n];
+    std::size_t strides[n];
+    for (std::size_t i = 0; i < n; ++i) {
+      exts[i] = layout_.extent(i);
+      strides[i] = layout_.stride(i);
+    }
+    return detail::make_subview(base_, exts, strides, specs...);
+  }
+
 private:
   template <std::size_t... seq, typename... Ts>
   auto end_impl(std::index_sequence<seq...>, Ts... indices) const {
@@ -92,8 +569,7 @@ private:
   }
 
   Iterator base_;
-  std::size_t steps_[max_dim + 1]{};
-  std::size_t num_elements_ = 0;
+  Layout layout_;
 };
 
 /// Makes a `multi_view` of the range beginning at `base` with dimension extents
@@ -103,6 +579,195 @@ auto make_multi_view(Iterator base, Ts... extents) {
   return multi_view<Iterator>(base, extents...);
 }
 
+/// Same as above, but with layout `Layout`, e.g.,
+/// `make_multi_view<morton>(base, 64, 64)`.
+template <typename Layout, typename = std::enable_if_t<
+            detail::is_multi_view_layout<Layout>::value>,
+          typename Iterator, typename... Ts>
+auto make_multi_view(Iterator base, Ts... extents) {
+  return multi_view<Iterator, Layout>(base, extents...);
+}
+
+/// Extent value denoting "given at runtime" for `fixed_multi_view`.
+constexpr std::size_t dynamic_extent = static_cast<std::size_t>(-1);
+
+namespace detail {
+
+// Returns the number of dynamic extents before dimension `dim`.
+template <std::size_t... extents>
+constexpr std::size_t count_dynamic(std::size_t dim) {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < dim; ++i) {
+    count += static_extent<extents...>(i) == dynamic_extent;
+  }
+  return count;
+}
+
+// Storage of `n` dynamic extents. Empty for none, so views with all extents
+// static take no space for them as a base.
+template <std::size_t n>
+class dynamic_extents {
+public:
+  template <typename... Ts>
+  explicit dynamic_extents(Ts... values)
+      : values_{ static_cast<std::size_t>(values)... } {
+    // nop
+  }
+
+  std::size_t operator [](std::size_t i) const {
+    return values_[i];
+  }
+
+private:
+  std::size_t values_[n];
+};
+
+template <>
+class dynamic_extents<0> {
+public:
+  std::size_t operator [](std::size_t) const {
+    return 0;
+  }
+};
+
+} // namespace detail
+
+/// Same as `multi_view`, but with the number of dimensions, i.e., the rank,
+/// fixed at compile time as `sizeof...(extents)`. Each of `extents...` is
+/// either a static extent or `dynamic_extent`, whose value is given at
+/// construction. Only dynamic extents are stored, so a view with all extents
+/// static is no larger than `Iterator`. Offsets are computed in Horner form,
+/// `(i0 * e1 + i1) * e2 + i2 ...`, with all loops of fixed trip counts, which
+/// compilers unroll into a chain of multiply-adds by constants.
+template <typename Iterator, std::size_t... extents>
+class fixed_multi_view
+    : private detail::dynamic_extents<
+        detail::count_dynamic<extents...>(sizeof...(extents))> {
+  static_assert(sizeof...(extents) > 0, "");
+  using dynamic_type = detail::dynamic_extents<
+    detail::count_dynamic<extents...>(sizeof...(extents))>;
+
+public:
+  /// Number of dimensions.
+  static constexpr std::size_t rank = sizeof...(extents);
+  /// Number of dynamic extents.
+  static constexpr std::size_t rank_dynamic =
+    detail::count_dynamic<extents...>(rank);
+
+  /// `base` is an iterator denoting a one-dimensional linear range.
+  /// `dynamic_extents...` specifies the value of each dynamic extent in order.
+  /// So, `sizeof...(dynamic_extents)` is `rank_dynamic`.
+  template <typename... Ts>
+  explicit fixed_multi_view(Iterator base, Ts... dynamic_extents)
+      : dynamic_type(dynamic_extents...),
+        base_(base) {
+    static_assert(sizeof...(dynamic_extents) == rank_dynamic, "");
+  }
+
+  /// Returns the extent of dimension `dim`.
+  std::size_t extent(std::size_t dim) const {
+    return static_extent(dim) == dynamic_extent ?
+           dynamic()[detail::count_dynamic<extents...>(dim)] :
+           static_extent(dim);
+  }
+
+  /// Returns the number of elements.
+  std::size_t size() const {
+    // offset of `(extent(0), 0, 0, ...)`
+    const std::size_t idxes[rank] = { extent<0>() };
+    return offset_of(std::make_index_sequence<rank>{}, idxes);
+  }
+
+  /// Same as `multi_view::begin()`.
+  template <typename... Ts>
+  auto begin(Ts... indices) const {
+    static_assert(sizeof...(indices) <= rank, "");
+    // zero filled
+    const std::size_t idxes[rank] = { static_cast<std::size_t>(indices)... };
+    return base_ + offset_of(std::make_index_sequence<rank>{}, idxes);
+  }
+
+  /// Same as `multi_view::end()`.
+  template <typename... Ts>
+  auto end(Ts... indices) const {
+    return end_impl(std::index_sequence_for<Ts...>{}, indices...);
+  }
+
+  /// Same as `multi_view::operator ()()`.
+  template <typename... Ts>
+  auto operator ()(Ts... indices) const {
+    return *begin(indices...);
+  }
+
+  /// Same as `multi_view::subview()`.
+  template <typename... Specs>
+  auto subview(Specs... specs) const {
+    static_assert(sizeof...(specs) == rank, "");
+    std::size_t exts[rank];
+    std::size_t strides[rank];
+    std::size_t acc = 1;
+    for (auto dim = rank; dim-- > 0;) {
+      exts[dim] = extent(dim);
+      strides[dim] = acc;
+      acc *= exts[dim];
+    }
+    return detail::make_subview(base_, exts, strides, specs...);
+  }
+
+private:
+  static constexpr std::size_t static_extent(std::size_t dim) {
+    return detail::static_extent<extents...>(dim);
+  }
+
+  const dynamic_type& dynamic() const {
+    return *this;
+  }
+
+  template <std::size_t dim>
+  std::size_t extent() const {
+    constexpr auto ext = static_extent(dim);
+    constexpr auto i = detail::count_dynamic<extents...>(dim);
+    return ext == dynamic_extent ? dynamic()[i] : ext;
+  }
+
+  // Unrolls the Horner form by pack expansion, with static extents as
+  // constants.
+  template <std::size_t... dims>
+  std::size_t offset_of(std::index_sequence<dims...>,
+                        const std::size_t* idxes) const {
+    std::size_t offset = 0;
+    using expand = int[];
+    (void)expand{ (offset = offset * extent<dims>() + idxes[dims], 0)... };
+    return offset;
+  }
+
+  auto end_impl(std::index_sequence<>) const {
+    return base_ + size();
+  }
+
+  template <std::size_t... seq, typename... Ts>
+  auto end_impl(std::index_sequence<seq...>, Ts... indices) const {
+    return begin(indices + (seq == sizeof...(Ts) - 1 ? 1 : 0) ...);
+  }
+
+  Iterator base_;
+};
+
+template <typename Iterator, std::size_t... extents>
+constexpr std::size_t fixed_multi_view<Iterator, extents...>::rank;
+
+template <typename Iterator, std::size_t... extents>
+constexpr std::size_t fixed_multi_view<Iterator, extents...>::rank_dynamic;
+
+/// Makes a `fixed_multi_view` of the range beginning at `base` with dimension
+/// extents `extents...`, where dynamic extents take values
+/// `dynamic_extents...`. For example,
+/// `make_fixed_multi_view<dynamic_extent, 4>(base, n)` views `n` rows of 4.
+template <std::size_t... extents, typename Iterator, typename... Ts>
+auto make_fixed_multi_view(Iterator base, Ts... dynamic_extents) {
+  return fixed_multi_view<Iterator, extents...>(base, dynamic_extents...);
+}
+
 } // namespace hhxx
 
 #endif // HHXX_MULTI_VIEW_HPP_
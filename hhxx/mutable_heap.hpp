@@ -7,85 +7,839 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <algorithm>
 #include <functional>
 #include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "hhxx/meta.hpp"
+
 namespace hhxx {
 
-/// Binary max-heap with mutable priorities. `Less` is the less-than comparator
-/// type that compares the priorities of objects referenced by key type
-/// `std::uintptr_t`.
-template <class Less = std::less<std::uintptr_t>>
-class mutable_heap {
+/// Position value denoting "not in the heap".
+constexpr std::size_t heap_npos = static_cast<std::size_t>(-1);
+
+/// Position index policy of `mutable_heap` backed by `std::unordered_map`.
+/// Works with arbitrary keys. Map nodes are allocated by allocator `Alloc`.
+template <class Alloc>
+class basic_hash_pos_index {
 public:
   using key_type = std::uintptr_t;
   using pos_type = std::size_t;
-  using map_type = std::unordered_map<key_type, pos_type>;
-  using vec_type = std::vector<key_type>;
+  using allocator_type = Alloc;
+
+private:
+  using map_alloc = typename std::allocator_traits<Alloc>::template
+                    rebind_alloc<std::pair<const key_type, pos_type>>;
+
+public:
+  /// Type of the map from keys to positions.
+  using map_type = std::unordered_map<key_type, pos_type, std::hash<key_type>,
+                                      std::equal_to<key_type>, map_alloc>;
 
-  /// Constructs a mutable heap using `less` as the less-than comparator.
-  explicit mutable_heap(Less less = Less{})
-      : less_(std::move(less)) {
+  /// The same policy using allocator `A` instead.
+  template <class A>
+  using rebind = basic_hash_pos_index<A>;
+
+  basic_hash_pos_index() = default;
+
+  explicit basic_hash_pos_index(const Alloc& alloc)
+      : map_(map_alloc(alloc)) {
+    // nop
+  }
+
+  /// Returns pointer to the position of `key`, or null if `key` is absent.
+  pos_type* find(key_type key) {
+    auto it = map_.find(key);
+    return it == map_.end() ? nullptr : &it->second;
+  }
+
+  const pos_type* find(key_type key) const {
+    auto it = map_.find(key);
+    return it == map_.end() ? nullptr : &it->second;
+  }
+
+  /// Inserts `key` at position `pos` if `key` is absent. Returns pointer to the
+  /// position of `key` and whether the insertion took place.
+  std::pair<pos_type*, bool> emplace(key_type key, pos_type pos) {
+    auto pr = map_.emplace(key, pos);
+    return {&pr.first->second, pr.second};
+  }
+
+  /// Returns reference to the position of `key`, which should be present.
+  pos_type& operator [](key_type key) {
+    return map_[key];
+  }
+
+  /// Removes `key`.
+  void erase(key_type key) {
+    map_.erase(key);
+  }
+
+  /// Removes all keys. `[first, last)` should enumerate all present keys.
+  template <class InputIt>
+  void clear(InputIt, InputIt) {
+    map_.clear();
+  }
+
+  /// Reserves storage for `cap` keys.
+  void reserve(pos_type cap) {
+    map_.reserve(cap);
+  }
+
+private:
+  map_type map_;
+};
+
+using hash_pos_index = basic_hash_pos_index<std::allocator<std::uintptr_t>>;
+
+/// Position index policy of `mutable_heap` backed by a flat `std::vector`
+/// indexed by key. Intended for keys densely populating `[0, n)`, e.g., node
+/// IDs. No hashing, and no per-key allocation once storage is reserved.
+/// Storage is allocated by allocator `Alloc`.
+template <class Alloc>
+class basic_dense_pos_index {
+public:
+  using key_type = std::uintptr_t;
+  using pos_type = std::size_t;
+  using allocator_type = Alloc;
+
+  template <class A>
+  using rebind = basic_dense_pos_index<A>;
+
+  basic_dense_pos_index() = default;
+
+  explicit basic_dense_pos_index(const Alloc& alloc)
+      : pos_(vec_alloc(alloc)) {
+    // nop
+  }
+
+  pos_type* find(key_type key) {
+    if (! (key < pos_.size()) || pos_[key] == heap_npos) return nullptr;
+    return &pos_[key];
+  }
+
+  const pos_type* find(key_type key) const {
+    if (! (key < pos_.size()) || pos_[key] == heap_npos) return nullptr;
+    return &pos_[key];
+  }
+
+  std::pair<pos_type*, bool> emplace(key_type key, pos_type pos) {
+    if (! (key < pos_.size())) pos_.resize(key + 1, heap_npos);
+    auto& key_pos = pos_[key];
+    if (key_pos != heap_npos) return {&key_pos, false};
+    key_pos = pos;
+    return {&key_pos, true};
+  }
+
+  pos_type& operator [](key_type key) {
+    assert(key < pos_.size());
+    return pos_[key];
+  }
+
+  void erase(key_type key) {
+    pos_[key] = heap_npos;
+  }
+
+  /// Only touches the slots of keys in `[first, last)`.
+  template <class InputIt>
+  void clear(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      pos_[*first] = heap_npos;
+    }
+  }
+
+  /// Makes room for keys `[0, cap)`.
+  void reserve(pos_type cap) {
+    if (pos_.size() < cap) pos_.resize(cap, heap_npos);
+  }
+
+private:
+  using vec_alloc = typename std::allocator_traits<Alloc>::template
+                    rebind_alloc<pos_type>;
+
+  std::vector<pos_type, vec_alloc> pos_;
+};
+
+using dense_pos_index = basic_dense_pos_index<std::allocator<std::uintptr_t>>;
+
+/// Position index policy of `mutable_heap` that stores the position of each key
+/// right inside the object referenced by the key, e.g., a timer object. `Hook`
+/// is a function object type such that `hook(key)` returns a `std::size_t&`
+/// referencing the position field of that object. The field should be
+/// initialized to `heap_npos`, and is reset to `heap_npos` once the key leaves
+/// the heap, including when the heap is destroyed. No hashing, and no memory
+/// overhead besides the field itself. Heaps using this policy can be moved but
+/// not copied, for copies would share the fields.
+template <class Hook>
+class intrusive_pos_index {
+public:
+  using key_type = std::uintptr_t;
+  using pos_type = std::size_t;
+
+  explicit intrusive_pos_index(Hook hook = Hook{})
+      : hook_(std::move(hook)) {
+    // nop
+  }
+
+  intrusive_pos_index(const intrusive_pos_index&) = delete;
+  intrusive_pos_index(intrusive_pos_index&&) = default;
+  intrusive_pos_index& operator =(const intrusive_pos_index&) = delete;
+  intrusive_pos_index& operator =(intrusive_pos_index&&) = default;
+
+  pos_type* find(key_type key) {
+    auto& key_pos = hook_(key);
+    return key_pos == heap_npos ? nullptr : &key_pos;
+  }
+
+  const pos_type* find(key_type key) const {
+    const auto& key_pos = hook_(key);
+    return key_pos == heap_npos ? nullptr : &key_pos;
+  }
+
+  std::pair<pos_type*, bool> emplace(key_type key, pos_type pos) {
+    auto& key_pos = hook_(key);
+    if (key_pos != heap_npos) return {&key_pos, false};
+    key_pos = pos;
+    return {&key_pos, true};
+  }
+
+  pos_type& operator [](key_type key) {
+    return hook_(key);
+  }
+
+  void erase(key_type key) {
+    hook_(key) = heap_npos;
+  }
+
+  template <class InputIt>
+  void clear(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      hook_(*first) = heap_npos;
+    }
+  }
+
+  /// No storage to reserve.
+  void reserve(pos_type) {
+    // nop
+  }
+
+private:
+  Hook hook_;
+};
+
+/// Hook for `intrusive_pos_index` when keys are addresses of `T` objects storing
+/// their positions in data member `member`.
+template <class T, std::size_t T::*member>
+struct member_pos_hook {
+  std::size_t& operator ()(std::uintptr_t key) const {
+    return reinterpret_cast<T*>(key)->*member;
+  }
+};
+
+/// Layout policy of `mutable_heap` that lays out nodes level by level in one
+/// flat array, i.e., the classic implicit heap layout.
+struct flat_heap_layout {
+  /// Returns position of the parent of node at position `pos > 0`.
+  template <std::size_t arity>
+  static std::size_t parent(std::size_t pos) {
+    return (pos - 1) / arity;
+  }
+
+  /// Returns position of the `i`-th child of node at position `pos`.
+  /// Children of a node have increasing positions.
+  template <std::size_t arity>
+  static std::size_t child(std::size_t pos, std::size_t i) {
+    return arity * pos + 1 + i;
+  }
+};
+
+/// Block-aware layout policy of `mutable_heap` in the spirit of B-heap. Nodes
+/// are grouped into blocks, each holding a complete subtree of `levels`
+/// levels. Blocks themselves form a tree and are laid out level by level, so
+/// sifting through a subtree of `levels` levels stays within one block of
+/// `(arity^levels - 1) / (arity - 1)` contiguous slots. Blocks are neither
+/// aligned nor sized to pages, and a partially filled level of blocks makes
+/// the tree deeper than a flat one. So far this is slower than
+/// `flat_heap_layout` of the same arity; see `bench/mutable_heap.cpp`.
+template <std::size_t levels>
+struct blocked_heap_layout {
+  static_assert(levels >= 2, "");
+
+  template <std::size_t arity>
+  static std::size_t parent(std::size_t pos) {
+    auto block = pos / block_size<arity>();
+    auto local = pos % block_size<arity>();
+    if (local) return block * block_size<arity>() + (local - 1) / arity;
+    auto parent_block = (block - 1) / num_child_blocks<arity>();
+    auto j = (block - 1) % num_child_blocks<arity>();
+    return parent_block * block_size<arity>() + first_leaf<arity>() + j / arity;
+  }
+
+  template <std::size_t arity>
+  static std::size_t child(std::size_t pos, std::size_t i) {
+    auto block = pos / block_size<arity>();
+    auto local = pos % block_size<arity>();
+    if (local < first_leaf<arity>()) {
+      return block * block_size<arity>() + arity * local + 1 + i;
+    }
+    auto j = arity * (local - first_leaf<arity>()) + i;
+    return (block * num_child_blocks<arity>() + 1 + j) * block_size<arity>();
+  }
+
+private:
+  static constexpr std::size_t pow(std::size_t base, std::size_t exp) {
+    return exp ? base * pow(base, exp - 1) : 1;
+  }
+
+  // number of nodes per block
+  template <std::size_t arity>
+  static constexpr std::size_t block_size() {
+    return (pow(arity, levels) - 1) / (arity - 1);
+  }
+
+  // local position of the first node on the bottom level of a block
+  template <std::size_t arity>
+  static constexpr std::size_t first_leaf() {
+    return (pow(arity, levels - 1) - 1) / (arity - 1);
+  }
+
+  template <std::size_t arity>
+  static constexpr std::size_t num_child_blocks() {
+    return pow(arity, levels);
+  }
+};
+
+/// Stats policy of `mutable_heap` that counts nothing. All hooks are empty, and
+/// the policy takes no space, so instrumentation compiles away.
+struct no_heap_stats {
+  void count_compare() {}
+  void count_sift_level() {}
+  void count_index_write() {}
+  void observe_size(std::size_t) {}
+};
+
+/// Stats policy of `mutable_heap` that counts the work done by heap operations.
+struct heap_stats {
+  /// Number of comparator calls.
+  std::uint64_t comparisons = 0;
+  /// Number of levels keys moved by in `sift_up()`/`sift_down()`.
+  std::uint64_t sift_levels = 0;
+  /// Number of position index writes, i.e., inserts, updates, and erases.
+  std::uint64_t index_writes = 0;
+  /// Largest number of elements the heap ever held.
+  std::size_t peak_size = 0;
+
+  void count_compare() {
+    ++comparisons;
+  }
+
+  void count_sift_level() {
+    ++sift_levels;
+  }
+
+  void count_index_write() {
+    ++index_writes;
+  }
+
+  void observe_size(std::size_t size) {
+    if (peak_size < size) peak_size = size;
+  }
+};
+
+namespace detail {
+
+// Position index policy `PosIndex` rebound to allocator `Alloc`, if supported.
+template <class PosIndex, class Alloc, class = void>
+struct rebind_pos_index {
+  using type = PosIndex;
+};
+
+template <class PosIndex, class Alloc>
+struct rebind_pos_index<PosIndex, Alloc, enable_if_well_formed_t<
+  typename PosIndex::template rebind<Alloc>>> {
+  using type = typename PosIndex::template rebind<Alloc>;
+};
+
+template <class PosIndex, class Alloc>
+using rebind_pos_index_t = typename rebind_pos_index<PosIndex, Alloc>::type;
+
+// Whether position index `PosIndex` keeps positions outside the heap, which
+// should then be reset when the heap goes away.
+template <class PosIndex>
+struct is_intrusive_pos_index : std::false_type {};
+
+template <class Hook>
+struct is_intrusive_pos_index<intrusive_pos_index<Hook>> : std::true_type {};
+
+// Constructs position index `PosIndex` using allocator `alloc`, if supported.
+
+template <class PosIndex, class Alloc>
+auto make_pos_index(const Alloc& alloc, char) -> decltype(PosIndex(alloc)) {
+  return PosIndex(alloc);
+}
+
+template <class PosIndex, class Alloc>
+PosIndex make_pos_index(const Alloc&, int) {
+  return PosIndex{};
+}
+
+inline std::uintptr_t heap_key(std::uintptr_t key) {
+  return key;
+}
+
+template <class Priority>
+std::uintptr_t heap_key(const std::pair<std::uintptr_t, Priority>& slot) {
+  return slot.first;
+}
+
+// Compares `(key, priority)` slots by priority.
+template <class Less>
+struct priority_less {
+  template <class Slot>
+  bool operator ()(const Slot& a, const Slot& b) const {
+    return less(a.second, b.second);
+  }
+  Less less;
+};
+
+// Implementation shared by `mutable_heap` and `mutable_priority_heap`. `Slot`
+// is what's stored in each heap slot, either a key or a `(key, priority)` pair.
+// `SlotLess` compares slots by priority. Derives from `Stats` to benefit from
+// empty base optimization.
+template <class Slot, class SlotLess, class PosIndex, std::size_t arity,
+          class Layout, class Alloc, class Stats>
+class heap_core : private Stats {
+  static_assert(arity >= 2, "");
+
+public:
+  using key_type = std::uintptr_t;
+  using pos_type = std::size_t;
+  using index_type = rebind_pos_index_t<PosIndex, Alloc>;
+  using allocator_type = Alloc;
+  using stats_type = Stats;
+  using vec_type = std::vector<Slot, typename std::allocator_traits<Alloc>::
+                                     template rebind_alloc<Slot>>;
+
+  heap_core(SlotLess less, index_type index, const Alloc& alloc)
+      : less_(std::move(less)),
+        heap_(typename vec_type::allocator_type(alloc)),
+        index_(std::move(index)) {
     // nop
   }
 
-  /// Constructs a mutable heap over the objects referenced by keys
-  /// `[first, last)` using `less` as the less-than comparator. All elements in
-  /// `[first, last)` should be distinct.
   template <class ForwardIt>
-  mutable_heap(ForwardIt first, ForwardIt last, Less less = Less{})
+  heap_core(ForwardIt first, ForwardIt last, SlotLess less, index_type index,
+            const Alloc& alloc)
       : less_(std::move(less)),
-        heap_(first, last) {
-    std::make_heap(heap_.begin(), heap_.end(), less_);
+        heap_(first, last, typename vec_type::allocator_type(alloc)),
+        index_(std::move(index)) {
     for (pos_type i = 0; i < heap_.size(); ++i) {
-      key_pos_map_.emplace(heap_[i], i);
+      index_.emplace(heap_key(heap_[i]), i);
+      this->count_index_write();
+    }
+    this->observe_size(heap_.size());
+    make_heap();
+  }
+
+  heap_core(const heap_core&) = default;
+  heap_core(heap_core&&) = default;
+  heap_core& operator =(const heap_core&) = default;
+
+  heap_core& operator =(heap_core&& other) {
+    release(is_intrusive_pos_index<index_type>{});
+    static_cast<Stats&>(*this) = std::move(other);
+    less_ = std::move(other.less_);
+    heap_ = std::move(other.heap_);
+    index_ = std::move(other.index_);
+    other.heap_.clear();
+    return *this;
+  }
+
+  ~heap_core() {
+    release(is_intrusive_pos_index<index_type>{});
+  }
+
+  /// Empties the heap.
+  void clear() {
+    index_.clear(key_begin(), key_end());
+    heap_.clear();
+  }
+
+  /// Returns the number of elements in the heap.
+  auto size() const {
+    return heap_.size();
+  }
+
+  /// Returns whether the heap is empty.
+  bool empty() const {
+    return heap_.empty();
+  }
+
+  /// Reserves storage for `cap` elements. With `dense_pos_index`, also makes
+  /// room for keys `[0, cap)` up front.
+  void reserve(pos_type cap) {
+    heap_.reserve(cap);
+    index_.reserve(cap);
+  }
+
+  /// Returns a copy of the allocator.
+  allocator_type get_allocator() const {
+    return allocator_type(heap_.get_allocator());
+  }
+
+  /// Returns the counters of the stats policy.
+  const stats_type& stats() const {
+    return *this;
+  }
+
+  /// Resets the counters of the stats policy.
+  void reset_stats() {
+    static_cast<stats_type&>(*this) = stats_type{};
+  }
+
+  /// Returns whether `key` is in the heap.
+  bool contains(key_type key) const {
+    return index_.find(key) != nullptr;
+  }
+
+  /// Removes `key` from the heap in `O(log(n))` time. Returns whether `key`
+  /// was in the heap.
+  bool erase(key_type key) {
+    auto key_pos = index_.find(key);
+    if (! key_pos) return false;
+    auto pos = *key_pos;
+    index_.erase(key);
+    this->count_index_write();
+    if (pos + 1 == heap_.size()) {
+      heap_.pop_back();
+      return true;
+    }
+    heap_[pos] = std::move(heap_.back());
+    heap_.pop_back();
+    this->count_index_write();
+    fix(index_[heap_key(heap_[pos])] = pos);
+    return true;
+  }
+
+  /// Takes the `k` highest priority keys (or all keys if fewer), and copies
+  /// them in descending order of priority to the range beginning at `out`.
+  /// Returns end of the output range.
+  template <class OutputIt>
+  OutputIt pop_n(pos_type k, OutputIt out) {
+    if (! (k < heap_.size())) return drain_sorted(out);
+    while (k--) {
+      *out++ = heap_key(pop_slot());
+    }
+    return out;
+  }
+
+  /// Takes all keys, and copies them in descending order of priority to the
+  /// range beginning at `out`. Returns end of the output range. Faster than
+  /// repeated `pop()`, for the position index is cleared in bulk, and slots
+  /// are sorted in place without maintaining the index.
+  template <class OutputIt>
+  OutputIt drain_sorted(OutputIt out) {
+    index_.clear(key_begin(), key_end());
+    std::sort(heap_.begin(), heap_.end(), [this](const Slot& a, const Slot& b) {
+      return slot_less(b, a);
+    });
+    for (const auto& slot : heap_) {
+      *out++ = heap_key(slot);
+    }
+    heap_.clear();
+    return out;
+  }
+
+protected:
+  const Slot& top_slot() const {
+    assert(! empty());
+    return heap_.front();
+  }
+
+  Slot pop_slot() {
+    assert(! empty());
+    auto slot = std::move(heap_.front());
+    heap_.front() = std::move(heap_.back());
+    auto& key_pos = index_[heap_key(heap_.front())] = 0;
+    index_.erase(heap_key(slot));
+    this->count_index_write();
+    this->count_index_write();
+    heap_.pop_back();
+    if (! empty()) sift_down(0, key_pos);
+    return slot;
+  }
+
+  // Inserts `slot`. If its key is already in the heap, replaces the existing
+  // slot and updates its position if necessary.
+  void push_slot(Slot slot) {
+    auto pr = index_.emplace(heap_key(slot), heap_.size());
+    if (pr.second) {
+      this->count_index_write();
+      heap_.emplace_back(std::move(slot));
+      this->observe_size(heap_.size());
+      sift_up(*pr.first, *pr.first);
+      return;
+    }
+    heap_[*pr.first] = std::move(slot);
+    fix(*pr.first);
+  }
+
+  // Rearranges `heap_` into a heap by Floyd's method in `O(n)` time. Parents
+  // are not monotonic in children with all layouts, so every node is visited.
+  // Index entry of a node is looked up only if the node moved.
+  void make_heap() {
+    for (auto i = heap_.size(); i-- > 0; ) {
+      pos_type key_pos;
+      if (sift_down(i, key_pos)) {
+        index_[heap_key(heap_[key_pos])] = key_pos;
+        this->count_index_write();
+      }
+    }
+  }
+
+  // Returns whether `make_heap()` is expected to be cheaper than restoring
+  // the heap property for `count` updated keys one at a time. The latter
+  // costs about `count * depth`, the former about `size()`.
+  bool make_heap_pays(pos_type count) const {
+    pos_type depth = 0;
+    for (auto n = heap_.size(); n; n /= arity) {
+      ++depth;
+    }
+    return count * depth >= heap_.size();
+  }
+
+  // Returns reference to index entry of `key`, which should be in the heap.
+  pos_type& pos_of(key_type key) {
+    auto key_pos = index_.find(key);
+    assert(key_pos);
+    return *key_pos;
+  }
+
+  // Restores the heap property after priority of the key at `key_pos` changed
+  // in an unknown direction.
+  void fix(pos_type& key_pos) {
+    if (sift_up(key_pos, key_pos)) return;
+    sift_down(key_pos, key_pos);
+  }
+
+  // `less_` that reports to the stats policy.
+  bool slot_less(const Slot& a, const Slot& b) {
+    this->count_compare();
+    return less_(a, b);
+  }
+
+  // Moves the key at `pos` towards the root while it has a higher priority
+  // than its parent. Returns whether the key moved, and updates `key_pos`,
+  // which may alias index entry of the key, to its final position.
+  bool sift_up(pos_type pos, pos_type& key_pos) {
+    if (pos == 0) return false;
+    auto parent = Layout::template parent<arity>(pos);
+    if (! slot_less(heap_[parent], heap_[pos])) return false;
+    auto slot = std::move(heap_[pos]);
+    do {
+      heap_[pos] = std::move(heap_[parent]);
+      index_[heap_key(heap_[pos])] = pos;
+      this->count_index_write();
+      this->count_sift_level();
+      pos = parent;
+      if (pos == 0) break;
+      parent = Layout::template parent<arity>(pos);
+    } while (slot_less(heap_[parent], slot));
+    heap_[pos] = std::move(slot);
+    key_pos = pos;
+    return true;
+  }
+
+  // Moves the key at `pos` towards the leaves while it has a lower priority
+  // than its highest priority child. Counterpart of `sift_up()`.
+  bool sift_down(pos_type pos, pos_type& key_pos) {
+    auto child = max_child(pos);
+    if (child == heap_npos || ! slot_less(heap_[pos], heap_[child])) {
+      return false;
+    }
+    auto slot = std::move(heap_[pos]);
+    do {
+      heap_[pos] = std::move(heap_[child]);
+      index_[heap_key(heap_[pos])] = pos;
+      this->count_index_write();
+      this->count_sift_level();
+      pos = child;
+      child = max_child(pos);
+    } while (child != heap_npos && slot_less(slot, heap_[child]));
+    heap_[pos] = std::move(slot);
+    key_pos = pos;
+    return true;
+  }
+
+  // Returns position of the highest priority child of `pos`, or `heap_npos`
+  // if `pos` is a leaf.
+  pos_type max_child(pos_type pos) {
+    auto max = Layout::template child<arity>(pos, 0);
+    if (! (max < heap_.size())) return heap_npos;
+    for (std::size_t i = 1; i < arity; ++i) {
+      auto child = Layout::template child<arity>(pos, i);
+      if (! (child < heap_.size())) break;
+      if (slot_less(heap_[max], heap_[child])) max = child;
+    }
+    return max;
+  }
+
+  SlotLess less_;
+  vec_type heap_;
+  index_type index_;
+
+private:
+  // Iterates keys of the heap slots.
+  class key_iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = key_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const key_type*;
+    using reference = key_type;
+
+    explicit key_iterator(typename vec_type::const_iterator it)
+        : it_(it) {
+      // nop
+    }
+    key_type operator *() const {
+      return heap_key(*it_);
+    }
+    key_iterator& operator ++() {
+      ++it_;
+      return *this;
     }
+    bool operator ==(const key_iterator& other) const {
+      return it_ == other.it_;
+    }
+    bool operator !=(const key_iterator& other) const {
+      return it_ != other.it_;
+    }
+
+  private:
+    typename vec_type::const_iterator it_;
+  };
+
+  key_iterator key_begin() const {
+    return key_iterator(heap_.begin());
+  }
+
+  key_iterator key_end() const {
+    return key_iterator(heap_.end());
+  }
+
+  // Resets positions of the keys held if they live outside the heap, so the
+  // objects may join another heap.
+  void release(std::true_type) {
+    index_.clear(key_begin(), key_end());
+  }
+
+  void release(std::false_type) {
+    // nop
+  }
+};
+
+} // namespace detail
+
+/// `arity`-ary max-heap with mutable priorities. `Less` is the less-than
+/// comparator type that compares the priorities of objects referenced by key
+/// type `std::uintptr_t`. `PosIndex` is the policy type that tracks the position
+/// of each key in the heap, e.g., `hash_pos_index` or `dense_pos_index`.
+/// `Layout` is the policy type that maps the tree to positions in the heap
+/// array, e.g., `flat_heap_layout` or `blocked_heap_layout`. `Alloc` is the
+/// allocator used for the heap array, and for the position index if it has a
+/// `rebind` member template, as `hash_pos_index` and `dense_pos_index` do.
+/// `Stats` is the policy type that counts the work done, e.g., `no_heap_stats`
+/// or `heap_stats`.
+template <class Less = std::less<std::uintptr_t>,
+          class PosIndex = hash_pos_index,
+          std::size_t arity = 2,
+          class Layout = flat_heap_layout,
+          class Alloc = std::allocator<std::uintptr_t>,
+          class Stats = no_heap_stats>
+class mutable_heap
+    : private detail::heap_core<std::uintptr_t, Less, PosIndex, arity, Layout,
+                                Alloc, Stats> {
+  using base = detail::heap_core<std::uintptr_t, Less, PosIndex, arity,
+                                 Layout, Alloc, Stats>;
+
+public:
+  using typename base::key_type;
+  using typename base::pos_type;
+  using typename base::index_type;
+  using typename base::allocator_type;
+  using typename base::stats_type;
+  using typename base::vec_type;
+  /// Map type of `hash_pos_index` with allocator `Alloc`, which was the
+  /// position index before it became a policy. Kept for compatibility.
+  using map_type = typename basic_hash_pos_index<Alloc>::map_type;
+
+  /// Constructs a mutable heap using `less` as the less-than comparator,
+  /// `index` as the position index, and `alloc` as the allocator.
+  explicit mutable_heap(Less less = Less{}, index_type index = index_type{},
+                        const Alloc& alloc = Alloc{})
+      : base(std::move(less), std::move(index), alloc) {
+    // nop
+  }
+
+  /// Constructs a mutable heap using `alloc` as the allocator of both the heap
+  /// array and the position index.
+  explicit mutable_heap(const Alloc& alloc)
+      : mutable_heap(Less{}, alloc) {
+    // nop
+  }
+
+  /// Same as above, but uses `less` as the less-than comparator.
+  mutable_heap(Less less, const Alloc& alloc)
+      : base(std::move(less),
+             detail::make_pos_index<index_type>(alloc, ' '), alloc) {
+    // nop
   }
 
   /// Constructs a mutable heap over the objects referenced by keys
-  /// in `list` using `less` as the less-than comparator. All elements in `list`
+  /// `[first, last)` using `less` as the less-than comparator, `index` as the
+  /// position index, and `alloc` as the allocator. All elements in
+  /// `[first, last)` should be distinct.
+  template <class ForwardIt>
+  mutable_heap(ForwardIt first, ForwardIt last, Less less = Less{},
+               index_type index = index_type{}, const Alloc& alloc = Alloc{})
+      : base(first, last, std::move(less), std::move(index), alloc) {
+    // nop
+  }
+
+  /// Constructs a mutable heap over the objects referenced by keys
+  /// in `list` using `less` as the less-than comparator, `index` as the
+  /// position index, and `alloc` as the allocator. All elements in `list`
   /// should be distinct.
   explicit mutable_heap(std::initializer_list<std::uintptr_t> list,
-                        Less less = Less{})
-      : mutable_heap(list.begin(), list.end(), std::move(less)) {
+                        Less less = Less{}, index_type index = index_type{},
+                        const Alloc& alloc = Alloc{})
+      : mutable_heap(list.begin(), list.end(), std::move(less),
+                     std::move(index), alloc) {
     // nop
   }
 
   /// Returns root of the heap.
   key_type top() const {
-    assert(! empty());
-    return heap_.front();
+    return this->top_slot();
   }
 
   /// Takes and returns root of the heap.
   key_type pop() {
-    assert(! empty());
-    auto key = top();
-    heap_.front() = heap_.back();
-    auto& key_pos = key_pos_map_[heap_.front()] = 0;
-    key_pos_map_.erase(key);
-    heap_.pop_back();
-    sift_down(heap_.begin(), heap_.end(), key_pos);
-    return key;
+    return this->pop_slot();
   }
 
   /// Add the object referenced by `key` to the heap. If it's already in the
   /// heap, its position in the heap is updated if necessary.
   void push(key_type key) {
-    auto pr = key_pos_map_.emplace(key, heap_.size());
-    if (pr.second) {
-      heap_.emplace_back(key);
-      sift_up(heap_.begin(), heap_.end(), pr.first->second);
-      return;
-    }
-    auto it = heap_.begin() + pr.first->second;
-    if (sift_up(heap_.begin(), it + 1, pr.first->second)) return;
-    sift_down(it, heap_.end(), pr.first->second);
-    return;
+    this->push_slot(key);
   }
 
   /// Same as `push()`.
@@ -93,84 +847,214 @@ public:
     push(key);
   }
 
-  /// Empties the heap.
-  void clear() {
-    heap_.clear();
-    key_pos_map_.clear();
+  /// Updates position of `key` after its priority increased. `key` should be
+  /// in the heap. Cheaper than `push()` for it only sifts towards the root.
+  void increase(key_type key) {
+    auto& key_pos = this->pos_of(key);
+    this->sift_up(key_pos, key_pos);
   }
 
-  /// Returns the number of elements in the heap.
-  auto size() const {
-    return heap_.size();
+  /// Updates position of `key` after its priority decreased. `key` should be
+  /// in the heap. Cheaper than `push()` for it only sifts towards the leaves.
+  void decrease(key_type key) {
+    auto& key_pos = this->pos_of(key);
+    this->sift_down(key_pos, key_pos);
   }
 
-  /// Returns whether the heap is empty.
-  bool empty() const {
-    return heap_.empty();
+  /// Updates positions of keys `[first, last)` after their priorities changed.
+  /// All keys should be in the heap. When the batch is a large enough share of
+  /// the heap, rebuilds the heap in `O(n)` time instead of `O(k log(n))`.
+  template <class ForwardIt>
+  void update_many(ForwardIt first, ForwardIt last) {
+    auto count = static_cast<pos_type>(std::distance(first, last));
+    if (this->make_heap_pays(count)) {
+      this->make_heap();
+      return;
+    }
+    for (; first != last; ++first) {
+      this->fix(this->pos_of(*first));
+    }
   }
 
-  /// Reserves storage for `cap` elements.
-  void reserve(pos_type cap) {
-    heap_.reserve(cap);
-    key_pos_map_.reserve(cap);
+  using base::clear;
+  using base::size;
+  using base::empty;
+  using base::reserve;
+  using base::get_allocator;
+  using base::stats;
+  using base::reset_stats;
+  using base::contains;
+  using base::erase;
+  using base::pop_n;
+  using base::drain_sorted;
+};
+
+/// `arity`-ary max-heap with mutable priorities stored inline. Each heap slot
+/// holds a `(key, priority)` pair, so sifting compares contiguous heap storage
+/// without dereferencing keys. `Less` is the less-than comparator type of
+/// priority type `Priority`. `PosIndex`, `Layout`, `Alloc` and `Stats` are the
+/// same as those of `mutable_heap`.
+template <class Priority, class Less = std::less<Priority>,
+          class PosIndex = hash_pos_index,
+          std::size_t arity = 2,
+          class Layout = flat_heap_layout,
+          class Alloc = std::allocator<std::uintptr_t>,
+          class Stats = no_heap_stats>
+class mutable_priority_heap
+    : private detail::heap_core<std::pair<std::uintptr_t, Priority>,
+                                detail::priority_less<Less>,
+                                PosIndex, arity, Layout, Alloc, Stats> {
+  using base = detail::heap_core<std::pair<std::uintptr_t, Priority>,
+                                 detail::priority_less<Less>,
+                                 PosIndex, arity, Layout, Alloc, Stats>;
+
+public:
+  using typename base::key_type;
+  using typename base::pos_type;
+  using typename base::index_type;
+  using typename base::allocator_type;
+  using typename base::stats_type;
+  using typename base::vec_type;
+  using priority_type = Priority;
+  /// Type of `(key, priority)` pairs, in the same order as arguments of
+  /// `push()` and `update()`.
+  using value_type = std::pair<key_type, Priority>;
+
+  /// Constructs a mutable priority heap using `less` as the less-than
+  /// comparator of priorities, `index` as the position index, and `alloc` as
+  /// the allocator.
+  explicit mutable_priority_heap(Less less = Less{},
+                                 index_type index = index_type{},
+                                 const Alloc& alloc = Alloc{})
+      : base(detail::priority_less<Less>{std::move(less)}, std::move(index),
+             alloc) {
+    // nop
   }
 
-private:
-  bool sift_up(vec_type::iterator first, vec_type::iterator last,
-               pos_type& key_pos) {
-    auto n = static_cast<pos_type>(last - first);
-    if (n < 2) return false;
-    auto parent = n / 2 - 1;
-    if (! less_(first[parent], last[-1])) return false;
-    auto key = std::exchange(last[-1], first[parent]);
-    key_pos_map_[last[-1]] = static_cast<pos_type>(last - first - 1);
-    while (true) {
-      last = first + parent + 1;
-      n = static_cast<pos_type>(last - first);
-      if (n < 2) break;
-      parent = n / 2 - 1;
-      if (! less_(first[parent], key)) break;
-      last[-1] = first[parent];
-      key_pos_map_[last[-1]] = static_cast<pos_type>(last - first - 1);
-    }
-    last[-1] = key;
-    key_pos = static_cast<pos_type>(last - first - 1);
-    return true;
+  /// Constructs a mutable priority heap using `alloc` as the allocator of both
+  /// the heap array and the position index.
+  explicit mutable_priority_heap(const Alloc& alloc)
+      : mutable_priority_heap(Less{}, alloc) {
+    // nop
   }
 
-  bool sift_down(vec_type::iterator first, vec_type::iterator last,
-                 pos_type& key_pos) {
-    auto first_pos = static_cast<pos_type>(first - heap_.begin());
-    auto last_pos = static_cast<pos_type>(last - heap_.begin());
-    auto child_pos = 2 * first_pos + 1;
-    if (! (child_pos < last_pos)) return false;
-    if (child_pos + 1 < last_pos
-        && less_(heap_[child_pos], heap_[child_pos + 1])) {
-      ++child_pos;
-    }
-    if (! less_(heap_[first_pos], heap_[child_pos])) return false;
-    auto key = std::exchange(heap_[first_pos], heap_[child_pos]);
-    key_pos_map_[heap_[first_pos]] = first_pos;
-    while (true) {
-      first_pos = child_pos;
-      child_pos = first_pos * 2 + 1;
-      if (! (child_pos < last_pos)) break;
-      if (child_pos + 1 < last_pos
-          && less_(heap_[child_pos], heap_[child_pos + 1])) {
-        ++child_pos;
+  /// Same as above, but uses `less` as the less-than comparator of priorities.
+  mutable_priority_heap(Less less, const Alloc& alloc)
+      : base(detail::priority_less<Less>{std::move(less)},
+             detail::make_pos_index<index_type>(alloc, ' '), alloc) {
+    // nop
+  }
+
+  /// Constructs a mutable priority heap over the `(key, priority)` pairs in
+  /// `[first, last)`. All keys should be distinct.
+  template <class ForwardIt>
+  mutable_priority_heap(ForwardIt first, ForwardIt last, Less less = Less{},
+                        index_type index = index_type{},
+                        const Alloc& alloc = Alloc{})
+      : base(first, last, detail::priority_less<Less>{std::move(less)},
+             std::move(index), alloc) {
+    // nop
+  }
+
+  /// Constructs a mutable priority heap over the `(key, priority)` pairs in
+  /// `list`. All keys should be distinct.
+  explicit mutable_priority_heap(std::initializer_list<value_type> list,
+                                 Less less = Less{},
+                                 index_type index = index_type{},
+                                 const Alloc& alloc = Alloc{})
+      : mutable_priority_heap(list.begin(), list.end(), std::move(less),
+                              std::move(index), alloc) {
+    // nop
+  }
+
+  /// Returns key of the root of the heap.
+  key_type top() const {
+    return this->top_slot().first;
+  }
+
+  /// Returns priority of the root of the heap.
+  const priority_type& top_priority() const {
+    return this->top_slot().second;
+  }
+
+  /// Takes and returns key of the root of the heap.
+  key_type pop() {
+    return this->pop_slot().first;
+  }
+
+  /// Adds `key` with `priority` to the heap. If `key` is already in the heap,
+  /// same as `update()`.
+  void push(key_type key, priority_type priority) {
+    this->push_slot(value_type(key, std::move(priority)));
+  }
+
+  /// Same as `push()`.
+  void emplace(key_type key, priority_type priority) {
+    push(key, std::move(priority));
+  }
+
+  /// Returns pointer to priority of `key`, or null if `key` is not in the
+  /// heap. Costs one position index lookup.
+  const priority_type* find_priority(key_type key) const {
+    auto key_pos = this->index_.find(key);
+    return key_pos ? &this->heap_[*key_pos].second : nullptr;
+  }
+
+  /// Changes priority of `key`, which should be in the heap, to `priority`.
+  void update(key_type key, priority_type priority) {
+    auto& key_pos = this->pos_of(key);
+    this->heap_[key_pos].second = std::move(priority);
+    this->fix(key_pos);
+  }
+
+  /// Same as `update()`, but `priority` should be no lower than the current
+  /// one. Cheaper for it only sifts towards the root.
+  void increase(key_type key, priority_type priority) {
+    auto& key_pos = this->pos_of(key);
+    assert(! this->less_.less(priority, this->heap_[key_pos].second));
+    this->heap_[key_pos].second = std::move(priority);
+    this->sift_up(key_pos, key_pos);
+  }
+
+  /// Same as `update()`, but `priority` should be no higher than the current
+  /// one. Cheaper for it only sifts towards the leaves.
+  void decrease(key_type key, priority_type priority) {
+    auto& key_pos = this->pos_of(key);
+    assert(! this->less_.less(this->heap_[key_pos].second, priority));
+    this->heap_[key_pos].second = std::move(priority);
+    this->sift_down(key_pos, key_pos);
+  }
+
+  /// Changes priorities as specified by the `(key, priority)` pairs in
+  /// `[first, last)`. All keys should be in the heap. When the batch is a large
+  /// enough share of the heap, rebuilds the heap in `O(n)` time instead of
+  /// `O(k log(n))`.
+  template <class ForwardIt>
+  void update_many(ForwardIt first, ForwardIt last) {
+    auto count = static_cast<pos_type>(std::distance(first, last));
+    if (! this->make_heap_pays(count)) {
+      for (; first != last; ++first) {
+        update(first->first, first->second);
       }
-      if (! less_(heap_[first_pos], heap_[child_pos])) break;
-      heap_[first_pos] = heap_[child_pos];
-      key_pos_map_[heap_[first_pos]] = first_pos;
+      return;
     }
-    heap_[first_pos] = key;
-    key_pos = first_pos;
-    return true;
+    for (; first != last; ++first) {
+      this->heap_[this->pos_of(first->first)].second = first->second;
+    }
+    this->make_heap();
   }
 
-  Less less_;
-  vec_type heap_;
-  map_type key_pos_map_;
+  using base::clear;
+  using base::size;
+  using base::empty;
+  using base::reserve;
+  using base::get_allocator;
+  using base::stats;
+  using base::reset_stats;
+  using base::contains;
+  using base::erase;
+  using base::pop_n;
+  using base::drain_sorted;
 };
 
 } // namespace hhxx
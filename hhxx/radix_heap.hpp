@@ -0,0 +1,204 @@
+// Copyright (c) 2016, Lingxi Li <lilingxi.cs@gmail.com>
+// All rights reserved.
+// Happy Hacking CXX Library (https://github.com/Lingxi-Li/Happy_Hacking_CXX)
+
+#ifndef HHXX_RADIX_HEAP_HPP_
+#define HHXX_RADIX_HEAP_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "hhxx/mutable_heap.hpp"
+
+namespace hhxx {
+
+/// Monotone min-heap with mutable unsigned integer priorities, known as radix
+/// heap. Monotone means that a key should never be given a priority lower than
+/// that of the last popped key, which holds for Dijkstra-style workloads.
+/// Keys are `std::uintptr_t` values. Keys are kept in `digits + 1` buckets by
+/// the highest bit where their priorities differ from the last popped one.
+/// Operations take amortized `O(log(C))` time, where `C` is the range of
+/// priorities, and mostly scan buckets sequentially. `PosIndex` is the same as
+/// that of `mutable_heap`.
+template <class Priority = std::uint64_t, class PosIndex = hash_pos_index>
+class radix_heap {
+  static_assert(std::is_unsigned<Priority>::value, "");
+
+public:
+  using key_type = std::uintptr_t;
+  using pos_type = std::size_t;
+  using index_type = PosIndex;
+  using priority_type = Priority;
+  /// Type of `(key, priority)` pairs, in the same order as arguments of
+  /// `push()`.
+  using value_type = std::pair<key_type, Priority>;
+
+  /// Constructs a radix heap using `index` as the position index.
+  explicit radix_heap(PosIndex index = PosIndex{})
+      : index_(std::move(index)) {
+    // nop
+  }
+
+  /// Returns key of the lowest priority. May move keys between buckets, hence
+  /// non-const.
+  key_type top() {
+    return top_slot().first;
+  }
+
+  /// Returns the lowest priority.
+  priority_type top_priority() {
+    return top_slot().second;
+  }
+
+  /// Takes and returns key of the lowest priority.
+  key_type pop() {
+    auto key = top_slot().first;
+    buckets_[0].pop_back();
+    index_.erase(key);
+    --size_;
+    return key;
+  }
+
+  /// Adds `key` with `priority` to the heap. If `key` is already in the heap,
+  /// same as `update()`. `priority` should be no lower than that of the last
+  /// popped key.
+  void push(key_type key, priority_type priority) {
+    assert(! (priority < last_));
+    auto pr = index_.emplace(key, heap_npos);
+    if (pr.second) {
+      ++size_;
+    }
+    else {
+      remove_at(*pr.first);
+    }
+    auto bucket = bucket_of(priority);
+    *pr.first = encode(buckets_[bucket].size(), bucket);
+    buckets_[bucket].emplace_back(key, priority);
+  }
+
+  /// Same as `push()`.
+  void emplace(key_type key, priority_type priority) {
+    push(key, priority);
+  }
+
+  /// Changes priority of `key`, which should be in the heap, to `priority`,
+  /// which should be no lower than that of the last popped key.
+  void update(key_type key, priority_type priority) {
+    assert(contains(key));
+    push(key, priority);
+  }
+
+  /// Returns whether `key` is in the heap.
+  bool contains(key_type key) const {
+    return index_.find(key) != nullptr;
+  }
+
+  /// Removes `key` from the heap. Returns whether `key` was in the heap.
+  bool erase(key_type key) {
+    auto key_pos = index_.find(key);
+    if (! key_pos) return false;
+    remove_at(*key_pos);
+    index_.erase(key);
+    --size_;
+    return true;
+  }
+
+  /// Empties the heap, and resets the last popped priority to zero.
+  void clear() {
+    for (auto& bucket : buckets_) {
+      for (const auto& slot : bucket) {
+        index_.erase(slot.first);
+      }
+      bucket.clear();
+    }
+    size_ = 0;
+    last_ = 0;
+  }
+
+  /// Returns the number of elements in the heap.
+  pos_type size() const {
+    return size_;
+  }
+
+  /// Returns whether the heap is empty.
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  /// Reserves storage for `cap` keys in the position index.
+  void reserve(pos_type cap) {
+    index_.reserve(cap);
+  }
+
+private:
+  static constexpr std::size_t num_buckets =
+    std::numeric_limits<Priority>::digits + 1;
+
+  static pos_type encode(pos_type idx, std::size_t bucket) {
+    return idx * num_buckets + bucket;
+  }
+
+  // Returns 0 if `priority` equals `last_`, otherwise one plus index of the
+  // highest bit where they differ, found by binary search.
+  std::size_t bucket_of(priority_type priority) const {
+    auto diff = priority ^ last_;
+    if (! diff) return 0;
+    std::size_t bucket = 1;
+    for (auto shift = num_buckets / 2; shift; shift /= 2) {
+      if (diff >> shift) {
+        diff >>= shift;
+        bucket += shift;
+      }
+    }
+    return bucket;
+  }
+
+  void remove_at(pos_type key_pos) {
+    auto& bucket = buckets_[key_pos % num_buckets];
+    auto idx = key_pos / num_buckets;
+    if (idx + 1 != bucket.size()) {
+      bucket[idx] = bucket.back();
+      index_[bucket[idx].first] = key_pos;
+    }
+    bucket.pop_back();
+  }
+
+  // Makes sure bucket 0 is non-empty, and returns its last slot.
+  const value_type& top_slot() {
+    assert(! empty());
+    if (buckets_[0].empty()) {
+      std::size_t i = 1;
+      while (buckets_[i].empty()) {
+        ++i;
+      }
+      auto& bucket = buckets_[i];
+      last_ = std::min_element(bucket.begin(), bucket.end(),
+        [](const value_type& a, const value_type& b) {
+          return a.second < b.second;
+        })->second;
+      for (const auto& slot : bucket) {
+        auto dest = bucket_of(slot.second);
+        index_[slot.first] = encode(buckets_[dest].size(), dest);
+        buckets_[dest].push_back(slot);
+      }
+      bucket.clear();
+    }
+    return buckets_[0].back();
+  }
+
+  std::vector<value_type> buckets_[num_buckets];
+  priority_type last_ = 0;
+  pos_type size_ = 0;
+  index_type index_;
+};
+
+} // namespace hhxx
+
+#endif // HHXX_RADIX_HEAP_HPP_
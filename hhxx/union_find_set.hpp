@@ -5,29 +5,154 @@
 #ifndef HHXX_UNION_FIND_SET_HPP_
 #define HHXX_UNION_FIND_SET_HPP_
 
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
+
+#include "hhxx/bit.hpp"
+#include "hhxx/meta.hpp"
 
 namespace hhxx {
 
+namespace detail {
+
+// Calls `f(t)` for each `t` in `[0, num_threads)`, each on a thread of its
+// own, and waits for all of them.
+template <class F>
+void for_each_thread(std::size_t num_threads, F f) {
+  if (num_threads <= 1) {
+    f(std::size_t(0));
+    return;
+  }
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back(f, t);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+// Calls `f(first, last)` on `num_threads` consecutive shares of `[0, count)`,
+// each on a thread of its own, and waits for all of them.
+template <class F>
+void parallel_for(std::size_t num_threads, std::size_t count, F f) {
+  num_threads = std::max<std::size_t>(num_threads, 1);
+  for_each_thread(num_threads, [&](std::size_t t) {
+    f(count * t / num_threads, count * (t + 1) / num_threads);
+  });
+}
+
+// Type of values written through output iterator `It`. Insert iterators have
+// `void` as `value_type`, so their container's is used, and `std::size_t` is
+// used for other such iterators.
+template <class It, class = void>
+struct output_value {
+  using value_type = typename std::iterator_traits<It>::value_type;
+  using type = std::conditional_t<std::is_void<value_type>::value,
+                                  std::size_t, value_type>;
+};
+
+template <class It>
+struct output_value<It, enable_if_well_formed_t<typename It::container_type>> {
+  using type = typename It::container_type::value_type;
+};
+
+template <class It>
+using output_value_t = typename output_value<It>::type;
+
+// Writes labels of elements `[0, n)` to `out[0, n)` using `num_threads`
+// threads, and returns the number of sets. Sets are labeled `0, 1, ...` in
+// increasing order. `is_root(x)` tells whether `x` is a set, and `root_of(x)`
+// returns the set containing `x`. Neither modifies anything, so threads only
+// write to their own shares. Roots go to an internal array in a first pass,
+// so `out` only needs to hold the labels, and the labels of sets replace
+// their roots in a second, after counting sets per share. A third pass writes
+// labels of all elements to `out`, looking up other elements through their
+// roots.
+template <class RandomIt, class IsRoot, class RootOf>
+std::size_t export_dense_labels(std::size_t n, RandomIt out,
+                                std::size_t num_threads, IsRoot is_root,
+                                RootOf root_of) {
+  using label_type = output_value_t<RandomIt>;
+  num_threads = std::max<std::size_t>(num_threads, 1);
+  std::vector<std::size_t> offset(num_threads + 1);
+  std::vector<std::size_t> root(n);
+  for_each_thread(num_threads, [&](std::size_t t) {
+    std::size_t count = 0;
+    const auto first = n * t / num_threads, last = n * (t + 1) / num_threads;
+    for (auto x = first; x < last; ++x) {
+      root[x] = static_cast<std::size_t>(root_of(x));
+      count += is_root(x);
+    }
+    offset[t + 1] = count;
+  });
+  for (std::size_t t = 0; t < num_threads; ++t) {
+    offset[t + 1] += offset[t];
+  }
+  for_each_thread(num_threads, [&](std::size_t t) {
+    auto label = offset[t];
+    const auto first = n * t / num_threads, last = n * (t + 1) / num_threads;
+    for (auto x = first; x < last; ++x) {
+      if (is_root(x)) root[x] = label++;
+    }
+  });
+  parallel_for(num_threads, n, [&](std::size_t first, std::size_t last) {
+    for (auto x = first; x < last; ++x) {
+      out[x] = static_cast<label_type>(is_root(x) ? root[x] : root[root[x]]);
+    }
+  });
+  return offset[num_threads];
+}
+
+} // namespace detail
+
 /// Disjoint sets data structure.
 /// Elements and sets are referenced by keys of type `std::uintptr_t`.
 /// In the initial state, each element `x` within `[0, UINTPTR_MAX]` is in a set
-/// of its own referenced by the same key `x`.
-class union_find_set {
+/// of its own referenced by the same key `x`. Nodes are allocated by allocator
+/// `Alloc`.
+template <class Alloc>
+class basic_union_find_set {
   struct Node {
     Node(std::uintptr_t iparent)
-        : parent(iparent), size(1) {
+        : parent(iparent), size(1), next(iparent) {
       // nop
     }
     std::uintptr_t parent;
     std::size_t size;
+    // next member of the same set, in a circular list
+    std::uintptr_t next;
   };
 
 public:
   /// Type of keys used to reference elements and sets.
   using key_type = std::uintptr_t;
+  using allocator_type = Alloc;
+
+  basic_union_find_set() = default;
+
+  /// Constructs an empty union-find set whose nodes are allocated by `alloc`.
+  explicit basic_union_find_set(const Alloc& alloc)
+      : parent_(map_alloc(alloc)) {
+    // nop
+  }
+
+  /// Returns a copy of the allocator.
+  allocator_type get_allocator() const {
+    return allocator_type(parent_.get_allocator());
+  }
 
   /// Returns the largest set containing `key`.
   key_type find(key_type key) {
@@ -45,19 +170,89 @@ public:
     }
     pair_it_a->second.size += pair_it_b->second.size;
     pair_it_b->second.parent = pair_it_a->first;
+    // splice the member lists
+    std::swap(pair_it_a->second.next, pair_it_b->second.next);
+    --num_sets_;
     return pair_it_a->first;
   }
 
+  /// Returns the number of elements in the largest set containing `key`.
+  std::size_t size_of(key_type key) {
+    return find_pair_it(key)->second.size;
+  }
+
+  /// Returns the number of sets among elements ever passed to the other
+  /// member functions since the last `reset()`. All other elements are in
+  /// sets of their own.
+  std::size_t num_sets() const {
+    return num_sets_;
+  }
+
+  /// Calls `f(member)` on each member of the largest set containing `key`, in
+  /// `O(size_of(key))` time. `f` should not modify the union-find set.
+  template <class F>
+  void for_each_member(key_type key, F f) const {
+    auto member = key;
+    do {
+      f(member);
+      auto it = parent_.find(member);
+      if (it == parent_.end()) return;
+      member = it->second.next;
+    } while (member != key);
+  }
+
+  /// Links every referenced element directly to its set, so later `find()`
+  /// calls take one hop. Returns `num_sets()`.
+  std::size_t compact() {
+    for (const auto& pr : parent_) {
+      find_pair_it(pr.first);
+    }
+    return num_sets_;
+  }
+
+  /// Writes labels of the largest sets containing keys in `[first, last)` to
+  /// the range beginning at `out`. Sets are labeled `0, 1, ...` in order of
+  /// first appearance. Returns end of the output range.
+  template <class InputIt, class OutputIt>
+  OutputIt export_labels(InputIt first, InputIt last, OutputIt out) {
+    // A labeled root holds the complement of its label in place of its size,
+    // which has the top bit set, while real sizes don't. Sizes are restored
+    // at the end, so no map from roots to labels is needed.
+    std::vector<std::pair<Node*, std::size_t>> labeled;
+    const auto top_bit = ~(~std::size_t(0) >> 1);
+    for (; first != last; ++first) {
+      auto& root = find_pair_it(*first)->second;
+      if (! (root.size & top_bit)) {
+        labeled.emplace_back(&root, root.size);
+        root.size = ~(labeled.size() - 1);
+      }
+      *out++ = static_cast<detail::output_value_t<OutputIt>>(~root.size);
+    }
+    for (const auto& pr : labeled) {
+      pr.first->size = pr.second;
+    }
+    return out;
+  }
+
   /// Resets to initial state where each element is in a set of its own
   /// referenced by the same key.
   void reset() {
     parent_.clear();
+    num_sets_ = 0;
   }
 
 private:
-  std::unordered_map<key_type, Node>::iterator find_pair_it(key_type key) {
+  using map_alloc = typename std::allocator_traits<Alloc>::template
+                    rebind_alloc<std::pair<const key_type, Node>>;
+  using map_type = std::unordered_map<key_type, Node, std::hash<key_type>,
+                                      std::equal_to<key_type>, map_alloc>;
+
+  typename map_type::iterator find_pair_it(key_type key) {
     auto pr = parent_.emplace(key, key);
-    if (pr.second) return pr.first;
+    if (pr.second) {
+      ++num_sets_;
+      return pr.first;
+    }
     auto it = pr.first;
     while (it->first != it->second.parent) {
       it = parent_.find(it->second.parent);
@@ -72,9 +267,626 @@ private:
     return pr.first;
   }
 
-  std::unordered_map<key_type, Node> parent_;
+  map_type parent_;
+  std::size_t num_sets_ = 0;
+};
+
+using union_find_set = basic_union_find_set<std::allocator<std::uintptr_t>>;
+
+/// Disjoint sets data structure over elements `[0, n)`, with the same semantics
+/// as `union_find_set`. Parents and set sizes are kept in arrays indexed by
+/// key and sized at construction, so `find()` follows array slots instead of
+/// hashing at each hop. Arrays are allocated by allocator `Alloc`.
+template <class Alloc>
+class basic_dense_union_find_set {
+public:
+  /// Type of keys used to reference elements and sets.
+  using key_type = std::uintptr_t;
+  using allocator_type = Alloc;
+
+  /// Constructs a union-find set over elements `[0, n)`, each in a set of its
+  /// own, using `alloc` as the allocator.
+  explicit basic_dense_union_find_set(std::size_t n,
+                                      const Alloc& alloc = Alloc{})
+      : parent_(n, key_alloc(alloc)),
+        size_(n, 1, size_alloc(alloc)),
+        next_(n, key_alloc(alloc)) {
+    reset();
+  }
+
+  /// Returns a copy of the allocator.
+  allocator_type get_allocator() const {
+    return allocator_type(parent_.get_allocator());
+  }
+
+  /// Returns the largest set containing `key`, which should be in `[0, n)`.
+  key_type find(key_type key) {
+    assert(key < parent_.size());
+    auto root = key;
+    while (parent_[root] != root) {
+      root = parent_[root];
+    }
+    while (parent_[key] != root) {
+      key = std::exchange(parent_[key], root);
+    }
+    return root;
+  }
+
+  /// Merges the largest sets containing `a` and `b` respectively, and returns
+  /// the resulting union set.
+  key_type unite(key_type a, key_type b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return a;
+    if (size_[a] < size_[b]) std::swap(a, b);
+    size_[a] += size_[b];
+    parent_[b] = a;
+    std::swap(next_[a], next_[b]);
+    --num_sets_;
+    return a;
+  }
+
+  /// Returns the number of elements in the largest set containing `key`.
+  std::size_t size_of(key_type key) {
+    return size_[find(key)];
+  }
+
+  /// Returns the number of sets.
+  std::size_t num_sets() const {
+    return num_sets_;
+  }
+
+  /// Calls `f(member)` on each member of the largest set containing `key`, in
+  /// `O(size_of(key))` time.
+  template <class F>
+  void for_each_member(key_type key, F f) const {
+    assert(key < parent_.size());
+    auto member = key;
+    do {
+      f(member);
+      member = next_[member];
+    } while (member != key);
+  }
+
+  /// Links every element directly to its set, so later `find()` calls take
+  /// one hop. Returns `num_sets()`.
+  std::size_t compact() {
+    for (key_type key = 0; key < parent_.size(); ++key) {
+      find(key);
+    }
+    return num_sets_;
+  }
+
+  /// Writes labels of the sets containing elements `[0, n)` to `out[0, n)`,
+  /// using `num_threads` threads. Sets are labeled `0, 1, ...` in increasing
+  /// order. Only reads the union-find set, so paths are not compressed; call
+  /// `compact()` first if they are long. Returns `num_sets()`.
+  template <class RandomIt>
+  std::size_t export_labels(RandomIt out, std::size_t num_threads = 1) const {
+    return detail::export_dense_labels(parent_.size(), out, num_threads,
+      [this](key_type key) {
+        return parent_[key] == key;
+      },
+      [this](key_type key) {
+        while (parent_[key] != key) {
+          key = parent_[key];
+        }
+        return key;
+      });
+  }
+
+  /// Resets to initial state where each element is in a set of its own
+  /// referenced by the same key.
+  void reset() {
+    for (key_type key = 0; key < parent_.size(); ++key) {
+      parent_[key] = key;
+      next_[key] = key;
+    }
+    std::fill(size_.begin(), size_.end(), 1);
+    num_sets_ = parent_.size();
+  }
+
+private:
+  using key_alloc = typename std::allocator_traits<Alloc>::template
+                    rebind_alloc<key_type>;
+  using size_alloc = typename std::allocator_traits<Alloc>::template
+                     rebind_alloc<std::size_t>;
+
+  std::vector<key_type, key_alloc> parent_;
+  std::vector<std::size_t, size_alloc> size_;
+  // next member of the same set, in a circular list
+  std::vector<key_type, key_alloc> next_;
+  std::size_t num_sets_;
 };
 
+using dense_union_find_set =
+  basic_dense_union_find_set<std::allocator<std::uintptr_t>>;
+
+/// Same as `dense_union_find_set`, but with one 32-bit slot per element, for
+/// sets of billions of elements where memory is the limit. A non-negative slot
+/// holds the parent, and a negative slot marks a root and holds the negated
+/// set size. `find()` halves paths in a single pass, so it needs no side
+/// storage either. `n` should be no more than `INT32_MAX`. There is no
+/// `for_each_member()`, which would take another slot per element.
+class compact_union_find_set {
+public:
+  /// Type of keys used to reference elements and sets.
+  using key_type = std::uintptr_t;
+
+  /// Constructs a union-find set over elements `[0, n)`, each in a set of its
+  /// own.
+  explicit compact_union_find_set(std::size_t n)
+      : slot_(n) {
+    assert(n <= static_cast<std::size_t>(INT32_MAX));
+    reset();
+  }
+
+  /// Returns the largest set containing `key`, which should be in `[0, n)`.
+  key_type find(key_type key) {
+    assert(key < slot_.size());
+    while (slot_[key] >= 0) {
+      auto parent = static_cast<key_type>(slot_[key]);
+      auto grandparent = slot_[parent];
+      if (grandparent < 0) return parent;
+      slot_[key] = grandparent;
+      key = static_cast<key_type>(grandparent);
+    }
+    return key;
+  }
+
+  /// Merges the largest sets containing `a` and `b` respectively, and returns
+  /// the resulting union set. Same result as `dense_union_find_set::unite()`.
+  key_type unite(key_type a, key_type b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return a;
+    // sizes are negated, so the larger set has the lower slot
+    if (slot_[b] < slot_[a]) std::swap(a, b);
+    slot_[a] += slot_[b];
+    slot_[b] = static_cast<std::int32_t>(a);
+    --num_sets_;
+    return a;
+  }
+
+  /// Returns the number of elements in the largest set containing `key`.
+  std::size_t size_of(key_type key) {
+    return static_cast<std::size_t>(-slot_[find(key)]);
+  }
+
+  /// Returns the number of sets.
+  std::size_t num_sets() const {
+    return num_sets_;
+  }
+
+  /// Same as `dense_union_find_set::compact()`.
+  std::size_t compact() {
+    for (key_type key = 0; key < slot_.size(); ++key) {
+      auto root = find(key);
+      if (root != key) slot_[key] = static_cast<std::int32_t>(root);
+    }
+    return num_sets_;
+  }
+
+  /// Same as `dense_union_find_set::export_labels()`.
+  template <class RandomIt>
+  std::size_t export_labels(RandomIt out, std::size_t num_threads = 1) const {
+    return detail::export_dense_labels(slot_.size(), out, num_threads,
+      [this](key_type key) {
+        return slot_[key] < 0;
+      },
+      [this](key_type key) {
+        while (slot_[key] >= 0) {
+          key = static_cast<key_type>(slot_[key]);
+        }
+        return key;
+      });
+  }
+
+  /// Resets to initial state where each element is in a set of its own
+  /// referenced by the same key.
+  void reset() {
+    std::fill(slot_.begin(), slot_.end(), -1);
+    num_sets_ = slot_.size();
+  }
+
+private:
+  std::vector<std::int32_t> slot_;
+  std::size_t num_sets_;
+};
+
+/// Same as `union_find_set`, but backed by a flat open-addressing table for
+/// sparse keys such as addresses. Each slot holds a key along with its parent
+/// slot and set size inline, so there is no node allocation per element, and
+/// `find()` hashes the key once and follows slot indices from there, also
+/// when compressing the path. Slots are probed linearly, and the table doubles
+/// once 3/4 full, which rebuilds parent links. `reserve()` avoids that.
+class flat_union_find_set {
+public:
+  /// Type of keys used to reference elements and sets.
+  using key_type = std::uintptr_t;
+
+  flat_union_find_set() {
+    // nop
+  }
+
+  /// Constructs an empty union-find set with room for `n` elements.
+  explicit flat_union_find_set(std::size_t n) {
+    reserve(n);
+  }
+
+  /// Returns the largest set containing `key`.
+  key_type find(key_type key) {
+    make_room(1);
+    return slots_[find_root(locate(key))].key;
+  }
+
+  /// Merges the largest sets containing `a` and `b` respectively, and returns
+  /// the resulting union set. Same result as `union_find_set::unite()`.
+  key_type unite(key_type a, key_type b) {
+    // grow up front, so slot indices stay valid
+    make_room(2);
+    auto root_a = find_root(locate(a));
+    auto root_b = find_root(locate(b));
+    if (root_a == root_b) return slots_[root_a].key;
+    if (slots_[root_a].size < slots_[root_b].size) std::swap(root_a, root_b);
+    slots_[root_a].size += slots_[root_b].size;
+    slots_[root_b].parent = root_a;
+    --num_sets_;
+    return slots_[root_a].key;
+  }
+
+  /// Returns the number of elements in the largest set containing `key`.
+  std::size_t size_of(key_type key) {
+    make_room(1);
+    return slots_[find_root(locate(key))].size;
+  }
+
+  /// Returns the number of sets among elements ever passed to the other
+  /// member functions since the last `reset()`. All other elements are in
+  /// sets of their own.
+  std::size_t num_sets() const {
+    return num_sets_;
+  }
+
+  /// Same as `union_find_set::compact()`.
+  std::size_t compact() {
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+      if (slots_[i].size) find_root(i);
+    }
+    return num_sets_;
+  }
+
+  /// Same as `union_find_set::export_labels()`.
+  template <class InputIt, class OutputIt>
+  OutputIt export_labels(InputIt first, InputIt last, OutputIt out) {
+    // Labeled roots hold complemented labels in place of sizes, as in
+    // `union_find_set`. The table may grow, so they are tracked by key.
+    std::vector<std::pair<key_type, std::size_t>> labeled;
+    const auto top_bit = ~(~std::size_t(0) >> 1);
+    for (; first != last; ++first) {
+      make_room(1);
+      auto& root = slots_[find_root(locate(*first))];
+      if (! (root.size & top_bit)) {
+        labeled.emplace_back(root.key, root.size);
+        root.size = ~(labeled.size() - 1);
+      }
+      *out++ = static_cast<detail::output_value_t<OutputIt>>(~root.size);
+    }
+    for (const auto& pr : labeled) {
+      slots_[locate(pr.first)].size = pr.second;
+    }
+    return out;
+  }
+
+  /// Makes room for `n` elements in total without growing the table.
+  void reserve(std::size_t n) {
+    std::size_t cap = 16;
+    while (cap / 4 * 3 < n) {
+      cap *= 2;
+    }
+    if (cap > slots_.size()) rehash(cap);
+  }
+
+  /// Resets to initial state where each element is in a set of its own
+  /// referenced by the same key. Keeps the table storage.
+  void reset() {
+    std::fill(slots_.begin(), slots_.end(), slot{});
+    size_ = 0;
+    num_sets_ = 0;
+  }
+
+private:
+  // `size` is zero for vacant slots.
+  struct slot {
+    key_type key;
+    std::size_t parent;
+    std::size_t size;
+  };
+
+  static std::size_t hash(key_type key) {
+    return static_cast<std::size_t>(detail::mix_bits(key));
+  }
+
+  // Grows the table as necessary for `k` more elements.
+  void make_room(std::size_t k) {
+    if (slots_.empty() || (size_ + k) * 4 > slots_.size() * 3) {
+      reserve(std::max<std::size_t>(size_ + k, slots_.size()));
+    }
+  }
+
+  // Returns the slot of `key`, occupying a vacant one if absent. There should
+  // be room for one more element.
+  std::size_t locate(key_type key) {
+    auto mask = slots_.size() - 1;
+    auto i = hash(key) & mask;
+    while (slots_[i].size && slots_[i].key != key) {
+      i = (i + 1) & mask;
+    }
+    if (! slots_[i].size) {
+      slots_[i] = slot{key, i, 1};
+      ++size_;
+      ++num_sets_;
+    }
+    return i;
+  }
+
+  std::size_t find_root(std::size_t i) {
+    auto root = i;
+    while (slots_[root].parent != root) {
+      root = slots_[root].parent;
+    }
+    while (slots_[i].parent != root) {
+      auto parent = slots_[i].parent;
+      slots_[i].parent = root;
+      i = parent;
+    }
+    return root;
+  }
+
+  // Moves all elements to a table of `cap` slots, and rebuilds parent links
+  // through a map from old slots to new ones.
+  void rehash(std::size_t cap) {
+    std::vector<slot> old(cap);
+    old.swap(slots_);
+    std::vector<std::size_t> moved(old.size());
+    auto mask = cap - 1;
+    for (std::size_t i = 0; i < old.size(); ++i) {
+      if (! old[i].size) continue;
+      auto j = hash(old[i].key) & mask;
+      while (slots_[j].size) {
+        j = (j + 1) & mask;
+      }
+      slots_[j] = old[i];
+      moved[i] = j;
+    }
+    for (auto& s : slots_) {
+      if (s.size) s.parent = moved[s.parent];
+    }
+  }
+
+  // capacity is zero or a power of two
+  std::vector<slot> slots_;
+  std::size_t size_ = 0;
+  std::size_t num_sets_ = 0;
+};
+
+/// Disjoint sets data structure over elements `[0, n)` that can undo unions.
+/// Uses union by size without path compression, so `find()` takes
+/// `O(log(n))` time and never modifies the structure, and each effective
+/// `unite()` changes exactly one parent link, which is logged. `rollback()`
+/// undoes the unions since a `checkpoint()` in time linear in their number.
+/// This supports backtracking search and offline dynamic connectivity.
+class rollback_union_find_set {
+public:
+  /// Type of keys used to reference elements and sets.
+  using key_type = std::uintptr_t;
+  /// Type of checkpoints, i.e., the number of effective unions so far.
+  using checkpoint_type = std::size_t;
+
+  /// Constructs a union-find set over elements `[0, n)`, each in a set of its
+  /// own.
+  explicit rollback_union_find_set(std::size_t n)
+      : parent_(n),
+        size_(n) {
+    reset();
+  }
+
+  /// Returns the largest set containing `key`, which should be in `[0, n)`.
+  key_type find(key_type key) const {
+    assert(key < parent_.size());
+    while (parent_[key] != key) {
+      key = parent_[key];
+    }
+    return key;
+  }
+
+  /// Merges the largest sets containing `a` and `b` respectively, and returns
+  /// the resulting union set. Same result as `union_find_set::unite()`.
+  key_type unite(key_type a, key_type b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return a;
+    if (size_[a] < size_[b]) std::swap(a, b);
+    size_[a] += size_[b];
+    parent_[b] = a;
+    log_.push_back(b);
+    return a;
+  }
+
+  /// Returns a checkpoint of the current state to roll back to.
+  checkpoint_type checkpoint() const {
+    return log_.size();
+  }
+
+  /// Undoes all unions since checkpoint `cp`, which should not be later than
+  /// the current state, nor earlier than the last `reset()`.
+  void rollback(checkpoint_type cp) {
+    assert(cp <= log_.size());
+    while (log_.size() > cp) {
+      auto child = log_.back();
+      log_.pop_back();
+      size_[parent_[child]] -= size_[child];
+      parent_[child] = child;
+    }
+  }
+
+  /// Resets to initial state where each element is in a set of its own
+  /// referenced by the same key, and forgets all checkpoints.
+  void reset() {
+    for (key_type key = 0; key < parent_.size(); ++key) {
+      parent_[key] = key;
+    }
+    std::fill(size_.begin(), size_.end(), 1);
+    log_.clear();
+  }
+
+private:
+  std::vector<key_type> parent_;
+  std::vector<std::size_t> size_;
+  // roots linked to others, in order
+  std::vector<key_type> log_;
+};
+
+/// Lock-free disjoint sets data structure over elements `[0, n)`, safe for
+/// concurrent `find()`, `unite()`, and `same_set()`. Each set is referenced by
+/// its smallest element. Linking always points the larger root at the smaller
+/// one by CAS, and `find()` does path halving by CAS, so no operation blocks,
+/// and progress is guaranteed as long as any thread runs. All atomic accesses
+/// are sequentially consistent, which costs nothing extra for loads on x86.
+class concurrent_union_find_set {
+public:
+  /// Type of keys used to reference elements and sets.
+  using key_type = std::uintptr_t;
+
+  /// Constructs a union-find set over elements `[0, n)`, each in a set of its
+  /// own.
+  explicit concurrent_union_find_set(std::size_t n)
+      : parent_(n) {
+    reset();
+  }
+
+  /// Returns the set containing `key`, which should be in `[0, n)`. The result
+  /// may be stale once returned, if other threads are uniting sets.
+  key_type find(key_type key) {
+    assert(key < parent_.size());
+    while (true) {
+      auto parent = parent_[key].load();
+      if (parent == key) return key;
+      auto grandparent = parent_[parent].load();
+      if (parent != grandparent) {
+        // path halving; losing the race is fine, someone did the work
+        parent_[key].compare_exchange_weak(parent, grandparent);
+      }
+      key = grandparent;
+    }
+  }
+
+  /// Merges the sets containing `a` and `b` respectively, and returns the
+  /// resulting union set, which is the smaller of the two roots.
+  key_type unite(key_type a, key_type b) {
+    while (true) {
+      a = find(a);
+      b = find(b);
+      if (a == b) return a;
+      if (a < b) std::swap(a, b);
+      // `a` may no longer be a root, in which case retry
+      auto expected = a;
+      if (parent_[a].compare_exchange_strong(expected, b)) return b;
+    }
+  }
+
+  /// Returns whether `a` and `b` are in the same set. Linearizable with
+  /// respect to concurrent `unite()`.
+  bool same_set(key_type a, key_type b) {
+    while (true) {
+      a = find(a);
+      b = find(b);
+      if (a == b) return true;
+      // roots never become roots again; if `a` is still a root, `a` and `b`
+      // were both roots when `b` was found
+      if (parent_[a].load() == a) return false;
+    }
+  }
+
+  /// Points each element in `[first, last)` directly at the root of its set,
+  /// so that subsequent `find()` on it takes one hop. May be called
+  /// concurrently with the other operations.
+  void compress(key_type first, key_type last) {
+    for (auto key = first; key < last; ++key) {
+      auto root = find(key);
+      if (root != key) parent_[key].store(root);
+    }
+  }
+
+  /// Resets to initial state where each element is in a set of its own
+  /// referenced by the same key. Not thread-safe.
+  void reset() {
+    for (key_type key = 0; key < parent_.size(); ++key) {
+      parent_[key].store(key, std::memory_order_relaxed);
+    }
+  }
+
+private:
+  std::vector<std::atomic<key_type>> parent_;
+};
+
+/// Labels the connected components of the graph of vertices `[0, n)` and edges
+/// `[first, last)`, using `num_threads` threads. Each edge `e` connects
+/// `std::get<0>(e)` and `std::get<1>(e)`, e.g., a `std::pair`. Returns an array
+/// of `n` labels, where the label of a vertex is the smallest vertex in its
+/// component. Two vertices have the same label if and only if `unite()` on all
+/// edges would put them into the same set.
+/// Works in the spirit of Afforest. First unites a sample of about `n` evenly
+/// spread edges, which usually forms a giant component, and compresses paths.
+/// Then unites the remaining edges. Most of them fall within the giant
+/// component, and are done after two one-hop `find()` calls, with no writes
+/// that would bounce cache lines between threads. Finally compresses again to
+/// produce the labels.
+template <class RandomIt>
+std::vector<std::uintptr_t> connected_components(RandomIt first,
+                                                 RandomIt last, std::size_t n,
+                                                 std::size_t num_threads = 1) {
+  using key_type = std::uintptr_t;
+  concurrent_union_find_set ufset(n);
+  auto m = static_cast<std::size_t>(last - first);
+  auto unite_edge = [&](std::size_t i) {
+    const auto& e = first[i];
+    ufset.unite(static_cast<key_type>(std::get<0>(e)),
+                static_cast<key_type>(std::get<1>(e)));
+  };
+  // average degree of two in the sample, well above the threshold of one for
+  // a giant component to emerge in random graphs
+  auto stride = n ? std::max<std::size_t>(m / n, 1) : 1;
+  detail::parallel_for(num_threads, (m + stride - 1) / stride,
+                       [&](std::size_t a, std::size_t b) {
+    for (auto i = a * stride; i < b * stride && i < m; i += stride) {
+      unite_edge(i);
+    }
+  });
+  if (stride > 1) {
+    detail::parallel_for(num_threads, n, [&](std::size_t a, std::size_t b) {
+      ufset.compress(a, b);
+    });
+    detail::parallel_for(num_threads, m, [&](std::size_t a, std::size_t b) {
+      auto sampled = (a + stride - 1) / stride * stride;
+      for (auto i = a; i < b; ++i) {
+        if (i == sampled) {
+          sampled += stride;
+          continue;
+        }
+        unite_edge(i);
+      }
+    });
+  }
+  std::vector<key_type> labels(n);
+  detail::parallel_for(num_threads, n, [&](std::size_t a, std::size_t b) {
+    for (auto v = a; v < b; ++v) {
+      labels[v] = ufset.find(static_cast<key_type>(v));
+    }
+  });
+  return labels;
+}
+
 } // namespace hhxx
 
 #endif // HHXX_UNION_FIND_SET_HPP_
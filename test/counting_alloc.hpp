@@ -0,0 +1,55 @@
+// Copyright (c) 2016, Lingxi Li <lilingxi.cs@gmail.com>
+// All rights reserved.
+// Happy Hacking CXX Library (https://github.com/Lingxi-Li/Happy_Hacking_CXX)
+
+#ifndef HHXX_TEST_COUNTING_ALLOC_HPP_
+#define HHXX_TEST_COUNTING_ALLOC_HPP_
+
+#include <cstddef>
+
+#include <memory>
+
+namespace hhxx_test {
+
+// Stateful allocator that counts live allocations.
+template <class T>
+struct counting_alloc {
+  using value_type = T;
+
+  explicit counting_alloc(std::size_t* live)
+      : live(live) {
+    // nop
+  }
+
+  template <class U>
+  counting_alloc(const counting_alloc<U>& other)
+      : live(other.live) {
+    // nop
+  }
+
+  T* allocate(std::size_t n) {
+    ++*live;
+    return std::allocator<T>{}.allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n) {
+    --*live;
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  std::size_t* live;
+};
+
+template <class T, class U>
+bool operator==(const counting_alloc<T>& a, const counting_alloc<U>& b) {
+  return a.live == b.live;
+}
+
+template <class T, class U>
+bool operator!=(const counting_alloc<T>& a, const counting_alloc<U>& b) {
+  return a.live != b.live;
+}
+
+} // namespace hhxx_test
+
+#endif // HHXX_TEST_COUNTING_ALLOC_HPP_
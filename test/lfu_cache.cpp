@@ -0,0 +1,91 @@
+// Copyright (c) 2016, Lingxi Li <lilingxi.cs@gmail.com>
+// All rights reserved.
+// Happy Hacking CXX Library (https://github.com/Lingxi-Li/Happy_Hacking_CXX)
+
+#include <hhxx/lfu_cache.hpp>
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+TEST(lfu_cache, basic) {
+  hhxx::lfu_cache<std::string> cache(3);
+  EXPECT_TRUE(cache.empty());
+  cache.put(1, "one");
+  cache.put(2, "two");
+  cache.put(3, "three");
+  EXPECT_EQ(3u, cache.size());
+  EXPECT_EQ("two", *cache.get(2));
+  EXPECT_EQ("two", *cache.get(2));
+  EXPECT_EQ("one", *cache.get(1));
+  EXPECT_EQ(3u, cache.score(2));
+  EXPECT_EQ(2u, cache.score(1));
+  EXPECT_EQ(1u, cache.score(3));
+  EXPECT_EQ(3u, cache.victim());
+  // evicts 3, the least frequently used
+  cache.put(4, "four");
+  EXPECT_FALSE(cache.contains(3));
+  EXPECT_EQ(nullptr, cache.get(3));
+  EXPECT_EQ(3u, cache.size());
+  // 4 is newer than 1 of the same score; 1 got accessed earlier, so goes next
+  EXPECT_EQ("four", *cache.get(4));
+  EXPECT_EQ(1u, cache.victim());
+  // peek doesn't bump
+  EXPECT_EQ("one", *cache.peek(1));
+  EXPECT_EQ(2u, cache.score(1));
+  // put to existing key replaces and bumps
+  cache.put(1, "uno");
+  EXPECT_EQ(3u, cache.score(1));
+  EXPECT_EQ("uno", *cache.peek(1));
+  EXPECT_EQ(4u, cache.victim());
+  EXPECT_TRUE(cache.erase(4));
+  EXPECT_FALSE(cache.erase(4));
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ(2u, cache.charge());
+  cache.clear();
+  EXPECT_TRUE(cache.empty());
+  EXPECT_EQ(0u, cache.charge());
+}
+
+TEST(lfu_cache, charge) {
+  hhxx::lfu_cache<int> cache(100);
+  cache.put(1, 1, 40);
+  cache.put(2, 2, 40);
+  cache.get(1);
+  EXPECT_EQ(80u, cache.charge());
+  // evicts 2 to fit
+  cache.put(3, 3, 30);
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_EQ(70u, cache.charge());
+  // growing the charge of an entry evicts others
+  cache.put(3, 3, 61);
+  EXPECT_FALSE(cache.contains(1));
+  EXPECT_EQ(61u, cache.charge());
+  // too large to fit at all
+  EXPECT_FALSE(cache.put(4, 4, 101));
+  EXPECT_FALSE(cache.contains(4));
+  EXPECT_TRUE(cache.contains(3));
+  EXPECT_FALSE(cache.put(3, 4, 101));
+  EXPECT_EQ(3, *cache.peek(3));
+  EXPECT_EQ(61u, cache.charge());
+  cache.set_capacity(50);
+  EXPECT_TRUE(cache.empty());
+  EXPECT_EQ(0u, cache.charge());
+  // slots are reused
+  cache.put(5, 5, 10);
+  EXPECT_EQ(5, *cache.get(5));
+}
+
+TEST(lfu_cache, oversized) {
+  hhxx::lfu_cache<int> cache(100);
+  for (int key = 0; key < 10; ++key) {
+    EXPECT_TRUE(cache.put(key, key, 5));
+  }
+  // rejected without evicting entries older than it
+  EXPECT_FALSE(cache.put(99, 0, 101));
+  EXPECT_FALSE(cache.contains(99));
+  EXPECT_EQ(10u, cache.size());
+  EXPECT_EQ(50u, cache.charge());
+  EXPECT_TRUE(cache.put(99, 0, 100));
+  EXPECT_EQ(1u, cache.size());
+}
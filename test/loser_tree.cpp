@@ -0,0 +1,70 @@
+// Copyright (c) 2016, Lingxi Li <lilingxi.cs@gmail.com>
+// All rights reserved.
+// Happy Hacking CXX Library (https://github.com/Lingxi-Li/Happy_Hacking_CXX)
+
+#include <hhxx/loser_tree.hpp>
+
+#include <cstddef>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(loser_tree, basic) {
+  using runs_type = std::vector<std::vector<int>>;
+  using tree_type = hhxx::loser_tree<std::vector<int>::const_iterator>;
+  const runs_type runs = {{1, 4, 7}, {}, {2, 2, 9}, {0, 5}, {3}};
+  tree_type tree(runs.begin(), runs.end());
+  EXPECT_EQ(5u, tree.num_runs());
+  std::vector<int> merged;
+  std::vector<std::size_t> sources;
+  while (! tree.empty()) {
+    merged.push_back(tree.top());
+    sources.push_back(tree.top_run());
+    tree.pop();
+  }
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 2, 3, 4, 5, 7, 9}), merged);
+  EXPECT_EQ((std::vector<std::size_t>{3, 0, 2, 2, 4, 0, 3, 0, 2}), sources);
+  // no runs
+  runs_type none;
+  EXPECT_TRUE(tree_type(none.begin(), none.end()).empty());
+}
+
+TEST(kway_merge, basic) {
+  std::vector<std::vector<int>> runs(37);
+  std::vector<int> expected;
+  for (std::size_t i = 0; i < runs.size(); ++i) {
+    for (std::size_t j = 0; j < i % 5 * 3; ++j) {
+      runs[i].push_back(static_cast<int>((i * 7 + j * 13) % 50));
+    }
+    std::sort(runs[i].begin(), runs[i].end(), std::greater<int>());
+    expected.insert(expected.end(), runs[i].begin(), runs[i].end());
+  }
+  std::sort(expected.begin(), expected.end(), std::greater<int>());
+  std::vector<int> merged;
+  hhxx::kway_merge(runs.begin(), runs.end(), std::back_inserter(merged),
+                   std::greater<int>());
+  EXPECT_EQ(expected, merged);
+}
+
+TEST(kway_merge, stable) {
+  using item = std::pair<int, int>;
+  auto by_first = [](const item& a, const item& b) {
+    return a.first < b.first;
+  };
+  std::vector<std::vector<item>> runs = {
+    {{1, 0}, {3, 0}}, {{1, 1}, {2, 1}, {3, 1}}, {{1, 2}, {3, 2}}
+  };
+  std::vector<item> merged(7);
+  auto end = hhxx::kway_merge(runs.begin(), runs.end(), merged.begin(),
+                              by_first);
+  EXPECT_EQ(merged.end(), end);
+  std::vector<item> expected = {
+    {1, 0}, {1, 1}, {1, 2}, {2, 1}, {3, 0}, {3, 1}, {3, 2}
+  };
+  EXPECT_EQ(expected, merged);
+}
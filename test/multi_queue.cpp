@@ -0,0 +1,97 @@
+// Copyright (c) 2016, Lingxi Li <lilingxi.cs@gmail.com>
+// All rights reserved.
+// Happy Hacking CXX Library (https://github.com/Lingxi-Li/Happy_Hacking_CXX)
+
+#include <hhxx/multi_queue.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(multi_queue, basic) {
+  using hhxx::multi_queue;
+  multi_queue<int> queue(4);
+  EXPECT_EQ(4u, queue.num_shards());
+  EXPECT_TRUE(queue.empty());
+  for (std::uintptr_t key = 0; key < 100; ++key) {
+    queue.push(key, static_cast<int>(key));
+  }
+  EXPECT_EQ(100u, queue.size());
+  queue.push(7, 1000);
+  EXPECT_EQ(100u, queue.size());
+  EXPECT_TRUE(queue.erase(8));
+  EXPECT_FALSE(queue.erase(8));
+  std::vector<bool> popped(100);
+  std::uintptr_t key;
+  int priority;
+  while (queue.try_pop(key, priority)) {
+    EXPECT_FALSE(popped[key]);
+    popped[key] = true;
+    EXPECT_EQ(key == 7 ? 1000 : static_cast<int>(key), priority);
+  }
+  EXPECT_TRUE(queue.empty());
+  for (std::uintptr_t key = 0; key < 100; ++key) {
+    EXPECT_EQ(key != 8, popped[key]);
+  }
+}
+
+TEST(multi_queue, relaxed_order) {
+  using hhxx::multi_queue;
+  multi_queue<int> queue(2);
+  for (std::uintptr_t key = 0; key < 100; ++key) {
+    queue.push(key, static_cast<int>(key));
+  }
+  // with two shards, the better of both roots is the global root
+  std::uintptr_t key;
+  for (std::uintptr_t expected = 100; expected-- > 0; ) {
+    EXPECT_TRUE(queue.try_pop(key));
+    EXPECT_EQ(expected, key);
+  }
+  EXPECT_FALSE(queue.try_pop(key));
+}
+
+TEST(multi_queue, concurrent) {
+  using hhxx::multi_queue;
+  const std::size_t num_threads = 4;
+  const std::uintptr_t num_keys = 20000;
+  multi_queue<std::uintptr_t> queue(4 * num_threads);
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&queue, t, num_threads, num_keys] {
+      for (auto key = t; key < num_keys; key += num_threads) {
+        queue.push(key, key);
+        queue.push(key, num_keys - key);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_keys, queue.size());
+  std::vector<std::vector<std::uintptr_t>> popped(num_threads);
+  threads.clear();
+  for (std::size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&queue, &popped, t] {
+      std::uintptr_t key;
+      while (queue.try_pop(key)) {
+        popped[t].push_back(key);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::vector<int> count(num_keys);
+  for (const auto& keys : popped) {
+    for (auto key : keys) {
+      ++count[key];
+    }
+  }
+  for (auto c : count) {
+    EXPECT_EQ(1, c);
+  }
+  EXPECT_TRUE(queue.empty());
+}
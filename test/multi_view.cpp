@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <iterator>
 #include <numeric>
+#include <type_traits>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -59,3 +60,184 @@ TEST(multi_view, basic) {
   EXPECT_EQ(1, view2x2x2());
   EXPECT_EQ(5, view2x2x2(1));
 }
+
+TEST(fixed_multi_view, basic) {
+  std::vector<int> vec(24);
+  std::iota(vec.begin(), vec.end(), 0);
+  hhxx::fixed_multi_view<std::vector<int>::iterator, 2, 3, 4> view(vec.begin());
+  EXPECT_EQ(3u, view.rank);
+  EXPECT_EQ(0u, view.rank_dynamic);
+  EXPECT_EQ(sizeof(vec.begin()), sizeof(view));
+  EXPECT_EQ(24u, view.size());
+  auto dynamic = hhxx::make_multi_view(vec.begin(), 2, 3, 4);
+  for (auto i = 0; i < 2; ++i) {
+    for (auto j = 0; j < 3; ++j) {
+      for (auto k = 0; k < 4; ++k) {
+        EXPECT_EQ(dynamic(i, j, k), view(i, j, k));
+      }
+      EXPECT_EQ(dynamic.begin(i, j), view.begin(i, j));
+      EXPECT_EQ(dynamic.end(i, j), view.end(i, j));
+    }
+    EXPECT_EQ(dynamic.end(i), view.end(i));
+  }
+  EXPECT_EQ(vec.begin(), view.begin());
+  EXPECT_EQ(vec.end(), view.end());
+  EXPECT_EQ(12, view(1));
+  using hhxx::dynamic_extent;
+  auto mixed = hhxx::make_fixed_multi_view<dynamic_extent, 3, dynamic_extent>(
+                 vec.begin(), 2, 4);
+  EXPECT_EQ(2u, mixed.rank_dynamic);
+  EXPECT_EQ(2u, mixed.extent(0));
+  EXPECT_EQ(3u, mixed.extent(1));
+  EXPECT_EQ(4u, mixed.extent(2));
+  EXPECT_EQ(23, mixed(1, 2, 3));
+  EXPECT_EQ(vec.end(), mixed.end());
+  int storage[] = { 1, 2, 3, 4 };
+  auto view2x2 = hhxx::make_fixed_multi_view<2, dynamic_extent>(storage, 2);
+  EXPECT_EQ(3, view2x2(1, 0));
+  EXPECT_EQ(2, std::distance(view2x2.begin(1), view2x2.end(1)));
+}
+
+TEST(subview, basic) {
+  std::vector<int> vec(24);
+  std::iota(vec.begin(), vec.end(), 0);
+  auto view = hhxx::make_multi_view(vec.begin(), 4, 6);
+  using hhxx::full_extent;
+  using hhxx::slice;
+  // column 2
+  auto col = view.subview(full_extent, 2);
+  EXPECT_EQ(4u, col.extent(0));
+  EXPECT_EQ(4u, col.size());
+  EXPECT_EQ(6u, col.stride(0));
+  for (auto r = 0; r < 4; ++r) {
+    EXPECT_EQ(view(r, 2), col(r));
+  }
+  // rows 1, 3 by columns 1, 3, 5
+  auto block = view.subview(slice{1, 4, 2}, slice{1, 6, 2});
+  EXPECT_EQ(2u, block.extent(0));
+  EXPECT_EQ(3u, block.extent(1));
+  for (auto i = 0; i < 2; ++i) {
+    for (auto j = 0; j < 3; ++j) {
+      EXPECT_EQ(view(1 + i * 2, 1 + j * 2), block(i, j));
+    }
+  }
+  // writes go to the same range
+  *block.begin(1, 2) = -1;
+  EXPECT_EQ(-1, vec[3 * 6 + 5]);
+  // subviews of subviews
+  auto elem = block.subview(1, slice{0, 3, 2});
+  EXPECT_EQ(2u, elem.extent(0));
+  EXPECT_EQ(-1, elem(1));
+  EXPECT_EQ(19, block.subview(1, 0)());
+  hhxx::fixed_multi_view<std::vector<int>::iterator, 2, 3, 4> fixed(
+    vec.begin());
+  auto plane = fixed.subview(full_extent, 1, slice{1, 3});
+  EXPECT_EQ(2u, plane.extent(0));
+  EXPECT_EQ(2u, plane.extent(1));
+  EXPECT_EQ(fixed(1, 1, 2), plane(1, 1));
+  EXPECT_EQ(5, plane());
+}
+
+namespace multi_view_test_ns {
+
+// Checks that `view` of extents `m x n` maps elements to distinct slots of its
+// span.
+template <typename View>
+void check_one_to_one(const View& view, int m, int n) {
+  std::vector<int> hits(view.span());
+  for (auto i = 0; i < m; ++i) {
+    for (auto j = 0; j < n; ++j) {
+      auto offset = view.begin(i, j) - view.begin();
+      ASSERT_LT(offset, static_cast<std::ptrdiff_t>(hits.size()));
+      EXPECT_EQ(0, hits[offset]++);
+    }
+  }
+}
+
+} // namespace multi_view_test_ns
+
+TEST(layout, explicit_iterator) {
+  int arr[6] = {0, 1, 2, 3, 4, 5};
+  auto view = hhxx::make_multi_view<int*>(arr, 2, 3);
+  EXPECT_TRUE((std::is_same<hhxx::multi_view<int*>, decltype(view)>::value));
+  EXPECT_EQ(5, view(1, 2));
+  auto cview = hhxx::make_multi_view<const int*>(arr, 2, 3);
+  EXPECT_TRUE((std::is_same<hhxx::multi_view<const int*>,
+                            decltype(cview)>::value));
+  EXPECT_EQ(3, cview(1, 0));
+}
+
+TEST(layout, column_major) {
+  std::vector<int> vec(6);
+  std::iota(vec.begin(), vec.end(), 0);
+  auto view = hhxx::make_multi_view<hhxx::column_major>(vec.begin(), 2, 3);
+  EXPECT_EQ(6u, view.span());
+  EXPECT_EQ(0, view(0, 0));
+  EXPECT_EQ(1, view(1, 0));
+  EXPECT_EQ(2, view(0, 1));
+  EXPECT_EQ(5, view(1, 2));
+  EXPECT_EQ(vec.end(), view.end());
+  auto row = view.subview(1, hhxx::full_extent);
+  EXPECT_EQ(3u, row.extent(0));
+  EXPECT_EQ(2u, row.stride(0));
+  EXPECT_EQ(3, row(1));
+  multi_view_test_ns::check_one_to_one(view, 2, 3);
+}
+
+TEST(layout, tiled) {
+  using layout = hhxx::tiled<2, 4>;
+  std::vector<int> vec(layout(3, 6).span());
+  EXPECT_EQ(32u, vec.size());
+  std::iota(vec.begin(), vec.end(), 0);
+  auto view = hhxx::make_multi_view<layout>(vec.begin(), 3, 6);
+  EXPECT_EQ(0, view(0, 0));
+  EXPECT_EQ(3, view(0, 3));
+  EXPECT_EQ(4, view(1, 0));
+  EXPECT_EQ(8, view(0, 4));
+  EXPECT_EQ(13, view(1, 5));
+  EXPECT_EQ(16, view(2, 0));
+  EXPECT_EQ(16, view(2));
+  EXPECT_EQ(vec.end(), view.end());
+  multi_view_test_ns::check_one_to_one(view, 3, 6);
+}
+
+TEST(layout, morton) {
+  std::vector<int> vec(64);
+  std::iota(vec.begin(), vec.end(), 0);
+  auto view = hhxx::make_multi_view<hhxx::morton>(vec.begin(), 8, 5);
+  EXPECT_EQ(64u, view.span());
+  EXPECT_EQ(0, view(0, 0));
+  EXPECT_EQ(1, view(0, 1));
+  EXPECT_EQ(2, view(1, 0));
+  EXPECT_EQ(3, view(1, 1));
+  EXPECT_EQ(4, view(0, 2));
+  EXPECT_EQ(8, view(2, 0));
+  EXPECT_EQ(63, view(7, 7));
+  multi_view_test_ns::check_one_to_one(view, 8, 5);
+  auto view3 = hhxx::make_multi_view<hhxx::morton>(vec.begin(), 4, 4, 4);
+  EXPECT_EQ(1, view3(0, 0, 1));
+  EXPECT_EQ(2, view3(0, 1, 0));
+  EXPECT_EQ(4, view3(1, 0, 0));
+  EXPECT_EQ(7 + 56, view3(3, 3, 3));
+  // padded to 4 x 4 x 4 x 4
+  std::vector<int> big(256);
+  std::iota(big.begin(), big.end(), 0);
+  auto view4 = hhxx::make_multi_view<hhxx::morton>(big.begin(), 2, 2, 4, 2);
+  EXPECT_EQ(256u, view4.span());
+  EXPECT_EQ(1, view4(0, 0, 0, 1));
+  EXPECT_EQ(2, view4(0, 0, 1, 0));
+  EXPECT_EQ(8, view4(1, 0, 0, 0));
+  EXPECT_EQ(2 + 32, view4(0, 0, 3, 0));
+  // same as generic bit-by-bit interleaving
+  big.resize(1 << 12);
+  auto view2 = hhxx::make_multi_view<hhxx::morton>(big.begin(), 64, 64);
+  for (auto i = 0; i < 64; ++i) {
+    for (auto j = 0; j < 64; ++j) {
+      std::ptrdiff_t expected = 0;
+      for (auto bit = 0; bit < 6; ++bit) {
+        expected |= (i >> bit & 1) << (2 * bit + 1) | (j >> bit & 1) << 2 * bit;
+      }
+      EXPECT_EQ(expected, view2.begin(i, j) - view2.begin());
+    }
+  }
+}
@@ -5,15 +5,26 @@
 #include <hhxx/mutable_heap.hpp>
 
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include <gtest/gtest.h>
 
+#include "counting_alloc.hpp"
+
 TEST(default_ctor, basic) {
   using hhxx::mutable_heap;
   mutable_heap<> heap;
   EXPECT_EQ(0u, heap.size());
   EXPECT_TRUE(heap.empty());
+  EXPECT_TRUE((std::is_same<
+    std::unordered_map<std::uintptr_t, std::size_t>,
+    mutable_heap<>::map_type>::value));
 }
 
 TEST(range_ctor_top_pop, basic) {
@@ -111,3 +122,451 @@ TEST(reserve, basic) {
     EXPECT_EQ(key, heap.pop());
   }
 }
+
+TEST(dense_pos_index, basic) {
+  using hhxx::mutable_heap;
+  using hhxx::dense_pos_index;
+  using mutable_heap_test_ns::less;
+  std::vector<int> priorities = {0, 1, 2, 3, 4};
+  mutable_heap<less, dense_pos_index> heap({0, 1, 2, 3, 4}, less(priorities));
+  priorities.assign({4, 3, 2, 1, 0});
+  for (auto key : {0, 1, 2, 3, 4}) {
+    heap.push(key);
+  }
+  std::uintptr_t key = 0;
+  while (heap.size()) {
+    EXPECT_EQ(key, heap.top());
+    EXPECT_EQ(key, heap.pop());
+    ++key;
+  }
+  heap.reserve(100);
+  // cover all keys pushed, for `less` to look up
+  priorities.resize(100);
+  for (auto key : {42, 7, 99}) {
+    heap.push(key);
+  }
+  heap.clear();
+  EXPECT_TRUE(heap.empty());
+  heap.push(3);
+  EXPECT_EQ(3u, heap.pop());
+}
+
+TEST(arity, basic) {
+  using hhxx::mutable_heap;
+  using hhxx::hash_pos_index;
+  using mutable_heap_test_ns::less;
+  std::vector<int> priorities(100);
+  for (std::size_t i = 0; i < priorities.size(); ++i) {
+    priorities[i] = static_cast<int>((i * 37) % priorities.size());
+  }
+  std::vector<std::uintptr_t> keys(priorities.size());
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = i;
+  }
+  mutable_heap<less, hash_pos_index, 4> heap4(keys.begin(), keys.end(),
+                                              less(priorities));
+  mutable_heap<less, hash_pos_index, 8> heap8{less(priorities)};
+  for (auto key : keys) {
+    heap8.push(key);
+  }
+  for (std::size_t i = 0; i < priorities.size(); i += 3) {
+    priorities[i] = -priorities[i];
+    heap4.push(i);
+    heap8.push(i);
+  }
+  auto last = static_cast<int>(priorities.size());
+  while (heap4.size()) {
+    EXPECT_EQ(heap4.top(), heap8.top());
+    auto key = heap4.pop();
+    EXPECT_EQ(key, heap8.pop());
+    EXPECT_LE(priorities[key], last);
+    last = priorities[key];
+  }
+  EXPECT_TRUE(heap8.empty());
+}
+
+namespace mutable_heap_test_ns {
+
+struct timer {
+  int due;
+  std::size_t heap_pos = hhxx::heap_npos;
+};
+
+struct later {
+  bool operator()(std::uintptr_t a, std::uintptr_t b) const {
+    return reinterpret_cast<timer*>(b)->due < reinterpret_cast<timer*>(a)->due;
+  }
+};
+
+} // namespace mutable_heap_test_ns
+
+TEST(intrusive_pos_index, basic) {
+  using hhxx::mutable_heap;
+  using mutable_heap_test_ns::timer;
+  using mutable_heap_test_ns::later;
+  using index = hhxx::intrusive_pos_index<
+                  hhxx::member_pos_hook<timer, &timer::heap_pos>>;
+  std::vector<timer> timers(5);
+  for (std::size_t i = 0; i < timers.size(); ++i) {
+    timers[i].due = static_cast<int>(i);
+  }
+  mutable_heap<later, index> heap;
+  for (auto& t : timers) {
+    heap.push(reinterpret_cast<std::uintptr_t>(&t));
+  }
+  for (auto& t : timers) {
+    EXPECT_NE(hhxx::heap_npos, t.heap_pos);
+  }
+  timers[3].due = -1;
+  heap.push(reinterpret_cast<std::uintptr_t>(&timers[3]));
+  EXPECT_EQ(&timers[3], reinterpret_cast<timer*>(heap.pop()));
+  EXPECT_EQ(hhxx::heap_npos, timers[3].heap_pos);
+  for (auto i : {0, 1, 2, 4}) {
+    EXPECT_EQ(&timers[i], reinterpret_cast<timer*>(heap.pop()));
+    EXPECT_EQ(hhxx::heap_npos, timers[i].heap_pos);
+  }
+  heap.push(reinterpret_cast<std::uintptr_t>(&timers[0]));
+  heap.clear();
+  EXPECT_EQ(hhxx::heap_npos, timers[0].heap_pos);
+}
+
+TEST(intrusive_pos_index, destroy) {
+  using hhxx::mutable_heap;
+  using mutable_heap_test_ns::timer;
+  using mutable_heap_test_ns::later;
+  using index = hhxx::intrusive_pos_index<
+                  hhxx::member_pos_hook<timer, &timer::heap_pos>>;
+  using heap_type = mutable_heap<later, index>;
+  EXPECT_FALSE(std::is_copy_constructible<heap_type>::value);
+  EXPECT_FALSE(std::is_copy_assignable<heap_type>::value);
+  std::vector<timer> timers(4);
+  for (std::size_t i = 0; i < timers.size(); ++i) {
+    timers[i].due = static_cast<int>(i);
+  }
+  {
+    heap_type heap;
+    for (auto& t : timers) {
+      heap.push(reinterpret_cast<std::uintptr_t>(&t));
+    }
+    heap_type moved(std::move(heap));
+    EXPECT_EQ(4u, moved.size());
+  }
+  for (auto& t : timers) {
+    EXPECT_EQ(hhxx::heap_npos, t.heap_pos);
+  }
+  heap_type heap;
+  heap.push(reinterpret_cast<std::uintptr_t>(&timers[3]));
+  EXPECT_EQ(1u, heap.size());
+  EXPECT_EQ(0u, timers[3].heap_pos);
+  heap_type other;
+  other.push(reinterpret_cast<std::uintptr_t>(&timers[1]));
+  heap = std::move(other);
+  EXPECT_EQ(hhxx::heap_npos, timers[3].heap_pos);
+  EXPECT_EQ(&timers[1], reinterpret_cast<timer*>(heap.pop()));
+}
+
+TEST(mutable_priority_heap, basic) {
+  using hhxx::mutable_priority_heap;
+  mutable_priority_heap<int> heap({{10, 0}, {11, 1}, {14, 4}});
+  heap.push(12, 2);
+  heap.emplace(13, 3);
+  EXPECT_EQ(5u, heap.size());
+  EXPECT_EQ(14u, heap.top());
+  EXPECT_EQ(4, heap.top_priority());
+  heap.update(10, 5);
+  heap.update(14, -1);
+  heap.push(11, 6);
+  std::vector<std::uintptr_t> expected = {11, 10, 13, 12, 14};
+  for (auto key : expected) {
+    EXPECT_EQ(key, heap.top());
+    EXPECT_EQ(key, heap.pop());
+  }
+  EXPECT_TRUE(heap.empty());
+}
+
+TEST(mutable_priority_heap, min_heap) {
+  using hhxx::mutable_priority_heap;
+  using hhxx::dense_pos_index;
+  mutable_priority_heap<double, std::greater<double>, dense_pos_index, 4> heap;
+  heap.reserve(10);
+  for (std::uintptr_t key = 0; key < 10; ++key) {
+    heap.push(key, 10.0 - key);
+  }
+  heap.update(0, 0.5);
+  EXPECT_EQ(0u, heap.pop());
+  for (std::uintptr_t key = 9; key > 0; --key) {
+    EXPECT_EQ(10.0 - key, heap.top_priority());
+    EXPECT_EQ(key, heap.pop());
+  }
+}
+
+TEST(increase_decrease, basic) {
+  using hhxx::mutable_heap;
+  using mutable_heap_test_ns::less;
+  std::vector<int> priorities = {0, 1, 2, 3, 4};
+  mutable_heap<less> heap({0, 1, 2, 3, 4}, less(priorities));
+  priorities[0] = 5;
+  heap.increase(0);
+  priorities[4] = -1;
+  heap.decrease(4);
+  std::vector<std::uintptr_t> expected = {0, 3, 2, 1, 4};
+  for (auto key : expected) {
+    EXPECT_EQ(key, heap.pop());
+  }
+}
+
+TEST(update_many, basic) {
+  using hhxx::mutable_heap;
+  using mutable_heap_test_ns::less;
+  std::vector<int> priorities(64);
+  std::vector<std::uintptr_t> keys(priorities.size());
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    priorities[i] = static_cast<int>(i);
+    keys[i] = i;
+  }
+  mutable_heap<less> heap(keys.begin(), keys.end(), less(priorities));
+  // small batch, updated one at a time
+  std::vector<std::uintptr_t> batch = {3, 60};
+  priorities[3] = 100;
+  priorities[60] = -100;
+  heap.update_many(batch.begin(), batch.end());
+  EXPECT_EQ(3u, heap.pop());
+  // large batch, rebuilt
+  batch.clear();
+  for (std::size_t i = 0; i < keys.size(); i += 3) {
+    if (i == 3) continue;
+    priorities[i] = -priorities[i];
+    batch.push_back(i);
+  }
+  heap.update_many(batch.begin(), batch.end());
+  auto last = heap.top();
+  while (heap.size()) {
+    auto key = heap.pop();
+    EXPECT_LE(priorities[key], priorities[last]);
+    last = key;
+  }
+}
+
+TEST(mutable_priority_heap, increase_decrease_update_many) {
+  using hhxx::mutable_priority_heap;
+  mutable_priority_heap<int, std::less<int>, hhxx::hash_pos_index, 4> heap;
+  for (std::uintptr_t key = 0; key < 32; ++key) {
+    heap.push(key, static_cast<int>(key));
+  }
+  heap.increase(0, 40);
+  heap.decrease(31, -1);
+  EXPECT_EQ(0u, heap.pop());
+  std::vector<std::pair<std::uintptr_t, int>> batch;
+  for (std::uintptr_t key = 1; key < 32; key += 2) {
+    batch.emplace_back(key, 100 + static_cast<int>(key));
+  }
+  heap.update_many(batch.begin(), batch.end());
+  for (int key = 31; key > 0; key -= 2) {
+    EXPECT_EQ(100 + key, heap.top_priority());
+    EXPECT_EQ(static_cast<std::uintptr_t>(key), heap.pop());
+  }
+  EXPECT_EQ(30u, heap.pop());
+  batch.assign({{2, 7}});
+  heap.update_many(batch.begin(), batch.end());
+  EXPECT_EQ(28u, heap.pop());
+}
+
+TEST(erase_contains, basic) {
+  using hhxx::mutable_heap;
+  using hhxx::dense_pos_index;
+  std::vector<std::uintptr_t> range = {0, 1, 4, 2, 3, 7, 6, 5};
+  mutable_heap<std::less<std::uintptr_t>, dense_pos_index> heap(
+    range.begin(), range.end());
+  EXPECT_TRUE(heap.contains(4));
+  EXPECT_FALSE(heap.contains(8));
+  EXPECT_FALSE(heap.erase(8));
+  EXPECT_TRUE(heap.erase(4));
+  EXPECT_FALSE(heap.contains(4));
+  EXPECT_TRUE(heap.erase(7));
+  EXPECT_TRUE(heap.erase(0));
+  EXPECT_EQ(5u, heap.size());
+  std::vector<std::uintptr_t> expected = {6, 5, 3, 2, 1};
+  for (auto key : expected) {
+    EXPECT_EQ(key, heap.pop());
+  }
+  EXPECT_FALSE(heap.contains(1));
+}
+
+TEST(mutable_priority_heap, erase_contains) {
+  using hhxx::mutable_priority_heap;
+  mutable_priority_heap<int> heap;
+  for (std::uintptr_t key = 0; key < 20; ++key) {
+    heap.push(key, static_cast<int>(key * 7 % 20));
+  }
+  for (std::uintptr_t key = 0; key < 20; key += 2) {
+    EXPECT_TRUE(heap.erase(key));
+    EXPECT_FALSE(heap.contains(key));
+    EXPECT_TRUE(heap.contains(key + 1));
+  }
+  auto last = heap.top_priority();
+  while (heap.size()) {
+    EXPECT_LE(heap.top_priority(), last);
+    last = heap.top_priority();
+    EXPECT_EQ(1u, heap.pop() % 2);
+  }
+}
+
+TEST(pop_n_drain_sorted, basic) {
+  using hhxx::mutable_heap;
+  std::vector<std::uintptr_t> range = {0, 1, 4, 2, 3, 7, 6, 5};
+  mutable_heap<> heap(range.begin(), range.end());
+  std::vector<std::uintptr_t> out;
+  heap.pop_n(3, std::back_inserter(out));
+  EXPECT_EQ(std::vector<std::uintptr_t>({7, 6, 5}), out);
+  EXPECT_EQ(5u, heap.size());
+  EXPECT_FALSE(heap.contains(7));
+  out.clear();
+  heap.drain_sorted(std::back_inserter(out));
+  EXPECT_EQ(std::vector<std::uintptr_t>({4, 3, 2, 1, 0}), out);
+  EXPECT_TRUE(heap.empty());
+  EXPECT_FALSE(heap.contains(0));
+  heap.push(1);
+  heap.push(9);
+  out.clear();
+  heap.pop_n(10, std::back_inserter(out));
+  EXPECT_EQ(std::vector<std::uintptr_t>({9, 1}), out);
+}
+
+TEST(mutable_priority_heap, pop_n_drain_sorted) {
+  using hhxx::mutable_priority_heap;
+  using hhxx::dense_pos_index;
+  mutable_priority_heap<int, std::less<int>, dense_pos_index> heap;
+  for (std::uintptr_t key = 0; key < 10; ++key) {
+    heap.push(key, static_cast<int>(10 - key));
+  }
+  std::uintptr_t out[10];
+  EXPECT_EQ(out + 2, heap.pop_n(2, out));
+  EXPECT_EQ(0u, out[0]);
+  EXPECT_EQ(1u, out[1]);
+  EXPECT_EQ(out + 8, heap.drain_sorted(out));
+  for (std::uintptr_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(i + 2, out[i]);
+    EXPECT_FALSE(heap.contains(i + 2));
+  }
+}
+
+TEST(blocked_heap_layout, basic) {
+  using layout = hhxx::blocked_heap_layout<3>;
+  // binary: blocks of 7 nodes, 8 child blocks per block
+  EXPECT_EQ(1u, layout::child<2>(0, 0));
+  EXPECT_EQ(4u, layout::child<2>(1, 1));
+  EXPECT_EQ(7u, layout::child<2>(3, 0));
+  EXPECT_EQ(14u, layout::child<2>(3, 1));
+  EXPECT_EQ(56u, layout::child<2>(6, 1));
+  EXPECT_EQ(8u, layout::child<2>(7, 0));
+  for (std::size_t pos = 0; pos < 1000; ++pos) {
+    for (std::size_t i = 0; i < 2; ++i) {
+      EXPECT_EQ(pos, layout::parent<2>(layout::child<2>(pos, i)));
+    }
+    for (std::size_t i = 0; i < 4; ++i) {
+      EXPECT_EQ(pos, layout::parent<4>(layout::child<4>(pos, i)));
+    }
+  }
+}
+
+TEST(blocked_heap_layout, heap) {
+  using hhxx::mutable_heap;
+  using hhxx::mutable_priority_heap;
+  using hhxx::dense_pos_index;
+  using layout = hhxx::blocked_heap_layout<2>;
+  using mutable_heap_test_ns::less;
+  std::vector<int> priorities(500);
+  std::vector<std::uintptr_t> keys(priorities.size());
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    priorities[i] = static_cast<int>((i * 263) % priorities.size());
+    keys[i] = i;
+  }
+  mutable_heap<less, dense_pos_index, 2, layout> heap2(
+    keys.begin(), keys.end(), less(priorities));
+  mutable_priority_heap<int, std::less<int>, dense_pos_index, 4, layout> heap4;
+  for (auto key : keys) {
+    heap4.push(key, priorities[key]);
+  }
+  for (std::size_t i = 0; i < keys.size(); i += 7) {
+    priorities[i] = -priorities[i];
+    heap2.push(i);
+    heap4.update(i, priorities[i]);
+  }
+  for (std::size_t i = 0; i < keys.size(); i += 11) {
+    heap2.erase(i);
+    heap4.erase(i);
+  }
+  while (heap2.size()) {
+    EXPECT_EQ(heap2.top(), heap4.top());
+    EXPECT_EQ(heap2.pop(), heap4.pop());
+  }
+  EXPECT_TRUE(heap4.empty());
+}
+
+TEST(allocator, basic) {
+  using hhxx::mutable_heap;
+  using hhxx::mutable_priority_heap;
+  using hhxx::hash_pos_index;
+  using hhxx::dense_pos_index;
+  using hhxx::flat_heap_layout;
+  using alloc = hhxx_test::counting_alloc<std::uintptr_t>;
+  std::size_t live = 0;
+  const alloc counting(&live);
+  {
+    using heap_type = mutable_heap<std::less<std::uintptr_t>, hash_pos_index,
+                                   2, flat_heap_layout, alloc>;
+    heap_type heap(counting);
+    EXPECT_EQ(&live, heap.get_allocator().live);
+    for (std::uintptr_t key = 0; key < 10; ++key) {
+      heap.push(key);
+    }
+    // heap array, plus buckets and nodes of the index
+    EXPECT_LT(10u, live);
+    for (std::uintptr_t key = 10; key--;) {
+      EXPECT_EQ(key, heap.pop());
+    }
+  }
+  EXPECT_EQ(0u, live);
+  {
+    using heap_type = mutable_priority_heap<int, std::greater<int>,
+                                            dense_pos_index, 4,
+                                            flat_heap_layout, alloc>;
+    heap_type heap(std::greater<int>{}, counting);
+    heap.reserve(10);
+    EXPECT_EQ(2u, live);
+    for (std::uintptr_t key = 0; key < 10; ++key) {
+      heap.push(key, -static_cast<int>(key));
+    }
+    EXPECT_EQ(2u, live);
+    EXPECT_EQ(9u, heap.top());
+  }
+  EXPECT_EQ(0u, live);
+}
+
+TEST(stats, basic) {
+  using hhxx::mutable_heap;
+  using hhxx::hash_pos_index;
+  using hhxx::flat_heap_layout;
+  using hhxx::heap_stats;
+  using less = std::less<std::uintptr_t>;
+  using alloc = std::allocator<std::uintptr_t>;
+  using heap_type = mutable_heap<less, hash_pos_index, 2, flat_heap_layout,
+                                 alloc, heap_stats>;
+  heap_type heap;
+  EXPECT_EQ(0u, heap.stats().comparisons);
+  // ascending keys sift all the way up
+  for (std::uintptr_t key = 0; key < 4; ++key) {
+    heap.push(key);
+  }
+  EXPECT_EQ(4u, heap.stats().comparisons);
+  EXPECT_EQ(4u, heap.stats().sift_levels);
+  EXPECT_EQ(8u, heap.stats().index_writes);
+  EXPECT_EQ(4u, heap.stats().peak_size);
+  heap.reset_stats();
+  EXPECT_EQ(0u, heap.stats().index_writes);
+  EXPECT_EQ(0u, heap.stats().peak_size);
+  EXPECT_EQ(3u, heap.pop());
+  EXPECT_LT(0u, heap.stats().comparisons);
+  // the default policy takes no space
+  EXPECT_EQ(sizeof(heap_type) - sizeof(heap_stats), sizeof(mutable_heap<>));
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2016, Lingxi Li <lilingxi.cs@gmail.com>
+// All rights reserved.
+// Happy Hacking CXX Library (https://github.com/Lingxi-Li/Happy_Hacking_CXX)
+
+#include <hhxx/radix_heap.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(radix_heap, basic) {
+  using hhxx::radix_heap;
+  radix_heap<> heap;
+  EXPECT_TRUE(heap.empty());
+  std::vector<std::uint64_t> priorities = {5, 0, 9, 1000, 3, 64, 65, 7};
+  for (std::uintptr_t key = 0; key < priorities.size(); ++key) {
+    heap.push(key, priorities[key]);
+  }
+  EXPECT_EQ(8u, heap.size());
+  EXPECT_EQ(1u, heap.top());
+  EXPECT_EQ(0u, heap.top_priority());
+  EXPECT_EQ(1u, heap.pop());
+  EXPECT_EQ(4u, heap.pop());
+  // monotone updates
+  heap.update(3, 4);
+  heap.push(2, 6);
+  heap.push(8, 3);
+  EXPECT_TRUE(heap.erase(6));
+  EXPECT_FALSE(heap.erase(6));
+  EXPECT_FALSE(heap.contains(6));
+  std::vector<std::uintptr_t> expected = {8, 3, 0, 2, 7, 5};
+  for (auto key : expected) {
+    EXPECT_EQ(key, heap.pop());
+    EXPECT_FALSE(heap.contains(key));
+  }
+  EXPECT_TRUE(heap.empty());
+}
+
+TEST(radix_heap, random) {
+  using hhxx::radix_heap;
+  using hhxx::dense_pos_index;
+  radix_heap<std::uint32_t, dense_pos_index> heap;
+  const std::uint32_t n = 2000;
+  heap.reserve(n);
+  std::vector<std::uint32_t> priorities(n);
+  std::uint32_t seed = 1;
+  auto rand = [&seed] { return seed = seed * 1103515245u + 12345u; };
+  for (std::uintptr_t key = 0; key < n; ++key) {
+    priorities[key] = rand() % 100000;
+    heap.push(key, priorities[key]);
+  }
+  std::uint32_t last = 0;
+  std::size_t count = 0;
+  while (! heap.empty()) {
+    auto priority = heap.top_priority();
+    auto key = heap.pop();
+    EXPECT_LE(last, priority);
+    EXPECT_EQ(priorities[key], priority);
+    last = priority;
+    ++count;
+    // lower some remaining priorities, but never below `last`
+    for (int i = 0; i < 2; ++i) {
+      auto other = rand() % n;
+      if (! heap.contains(other) || priorities[other] == last) continue;
+      priorities[other] = last + (priorities[other] - last) / 2;
+      heap.update(other, priorities[other]);
+    }
+  }
+  EXPECT_EQ(n, count);
+  heap.push(1, last);
+  heap.clear();
+  EXPECT_TRUE(heap.empty());
+  heap.push(1, 0);
+  EXPECT_EQ(1u, heap.pop());
+}
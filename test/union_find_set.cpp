@@ -4,8 +4,21 @@
 
 #include <hhxx/union_find_set.hpp>
 
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include <gtest/gtest.h>
 
+#include "counting_alloc.hpp"
+
 TEST(find_unite_reset, basic) {
   using hhxx::union_find_set;
   using key_type = union_find_set::key_type;
@@ -29,3 +42,343 @@ TEST(find_unite_reset, basic) {
     EXPECT_EQ(key, ufset.find(key));
   }
 }
+
+TEST(allocator, basic) {
+  using alloc = hhxx_test::counting_alloc<std::uintptr_t>;
+  std::size_t live = 0;
+  {
+    hhxx::basic_union_find_set<alloc> ufset{alloc(&live)};
+    EXPECT_EQ(&live, ufset.get_allocator().live);
+    EXPECT_EQ(0u, ufset.unite(0, 1));
+    EXPECT_EQ(0u, ufset.find(1));
+    EXPECT_LT(0u, live);
+    ufset.reset();
+  }
+  EXPECT_EQ(0u, live);
+}
+
+TEST(dense_union_find_set, basic) {
+  using hhxx::dense_union_find_set;
+  using key_type = dense_union_find_set::key_type;
+  dense_union_find_set ufset(5);
+  key_type key = 0;
+  for (key = 0; key < 5; ++key) {
+    EXPECT_EQ(key, ufset.find(key));
+  }
+  EXPECT_EQ(0u, ufset.unite(0, 1));
+  EXPECT_EQ(2u, ufset.unite(2, 3));
+  EXPECT_EQ(2u, ufset.unite(3, 4));
+  EXPECT_EQ(2u, ufset.unite(1, 4));
+  EXPECT_EQ(2u, ufset.unite(0, 3));
+  for (key = 0; key < 5; ++key) {
+    EXPECT_EQ(2u, ufset.find(key));
+  }
+  ufset.reset();
+  for (key = 0; key < 5; ++key) {
+    EXPECT_EQ(key, ufset.find(key));
+  }
+}
+
+TEST(dense_union_find_set, same_as_union_find_set) {
+  hhxx::union_find_set expected;
+  hhxx::dense_union_find_set ufset(1000);
+  for (std::uintptr_t i = 0; i < 700; ++i) {
+    auto a = i * 263 % 1000;
+    auto b = i * 379 % 1000;
+    EXPECT_EQ(expected.unite(a, b), ufset.unite(a, b));
+  }
+  for (std::uintptr_t key = 0; key < 1000; ++key) {
+    EXPECT_EQ(expected.find(key), ufset.find(key));
+  }
+}
+
+TEST(compact_union_find_set, same_as_dense_union_find_set) {
+  hhxx::dense_union_find_set expected(1000);
+  hhxx::compact_union_find_set ufset(1000);
+  EXPECT_EQ(1000u, ufset.num_sets());
+  for (std::uintptr_t i = 0; i < 700; ++i) {
+    auto a = i * 263 % 1000;
+    auto b = i * 379 % 1000;
+    EXPECT_EQ(expected.unite(a, b), ufset.unite(a, b));
+  }
+  EXPECT_EQ(expected.num_sets(), ufset.num_sets());
+  for (std::uintptr_t key = 0; key < 1000; ++key) {
+    EXPECT_EQ(expected.find(key), ufset.find(key));
+    EXPECT_EQ(expected.size_of(key), ufset.size_of(key));
+  }
+  ufset.reset();
+  EXPECT_EQ(1000u, ufset.num_sets());
+  for (std::uintptr_t key = 0; key < 1000; ++key) {
+    EXPECT_EQ(key, ufset.find(key));
+    EXPECT_EQ(1u, ufset.size_of(key));
+  }
+}
+
+TEST(flat_union_find_set, same_as_union_find_set) {
+  hhxx::union_find_set expected;
+  // starts small to grow several times
+  hhxx::flat_union_find_set ufset;
+  // sparse keys like addresses
+  auto key_of = [](std::uintptr_t i) {
+    return i * 4096 + 0x10000;
+  };
+  for (std::uintptr_t i = 0; i < 700; ++i) {
+    auto a = key_of(i * 263 % 1000);
+    auto b = key_of(i * 379 % 1000);
+    EXPECT_EQ(expected.unite(a, b), ufset.unite(a, b));
+  }
+  for (std::uintptr_t i = 0; i < 1000; ++i) {
+    auto key = key_of(i);
+    EXPECT_EQ(expected.find(key), ufset.find(key));
+    EXPECT_EQ(expected.size_of(key), ufset.size_of(key));
+  }
+  EXPECT_EQ(expected.num_sets(), ufset.num_sets());
+  ufset.reset();
+  EXPECT_EQ(0u, ufset.num_sets());
+  EXPECT_EQ(key_of(1), ufset.find(key_of(1)));
+  EXPECT_EQ(1u, ufset.num_sets());
+}
+
+TEST(concurrent_union_find_set, basic) {
+  hhxx::concurrent_union_find_set ufset(5);
+  EXPECT_EQ(3u, ufset.find(3));
+  EXPECT_FALSE(ufset.same_set(3, 4));
+  EXPECT_EQ(3u, ufset.unite(4, 3));
+  EXPECT_EQ(1u, ufset.unite(1, 2));
+  EXPECT_EQ(1u, ufset.unite(4, 2));
+  EXPECT_EQ(1u, ufset.find(3));
+  EXPECT_TRUE(ufset.same_set(2, 4));
+  EXPECT_FALSE(ufset.same_set(0, 4));
+  ufset.reset();
+  EXPECT_EQ(4u, ufset.find(4));
+}
+
+TEST(concurrent_union_find_set, threads) {
+  const std::size_t n = 1 << 16;
+  const std::size_t num_threads = 4;
+  hhxx::concurrent_union_find_set ufset(n);
+  // each thread links a strided share of the chains `i -> i + 2`, so the
+  // even and the odd elements end up in two sets
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      for (auto i = t; i + 2 < n; i += num_threads) {
+        ufset.unite(i + 2, i);
+        EXPECT_TRUE(ufset.same_set(i, i + 2));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (std::uintptr_t key = 0; key < n; ++key) {
+    EXPECT_EQ(key % 2, ufset.find(key));
+  }
+  EXPECT_FALSE(ufset.same_set(0, 1));
+}
+
+TEST(connected_components, basic) {
+  using edge = std::pair<std::uintptr_t, std::uintptr_t>;
+  const std::size_t n = 5000;
+  std::vector<edge> edges;
+  // a giant component over multiples of 3, plus scattered small ones
+  for (std::uintptr_t i = 0; i + 3 < n; i += 3) {
+    edges.emplace_back(i * 7 % (n / 3) * 3, i);
+  }
+  for (std::uintptr_t i = 1; i + 10 < n; i += 10) {
+    edges.emplace_back(i + 10 - i % 20 / 10, i);
+  }
+  hhxx::union_find_set expected;
+  for (const auto& e : edges) {
+    expected.unite(e.first, e.second);
+  }
+  for (std::size_t num_threads : {1, 4}) {
+    auto labels = hhxx::connected_components(edges.begin(), edges.end(), n,
+                                             num_threads);
+    ASSERT_EQ(n, labels.size());
+    for (std::uintptr_t v = 0; v < n; ++v) {
+      EXPECT_LE(labels[v], v);
+      EXPECT_EQ(labels[v], labels[labels[v]]);
+      EXPECT_EQ(expected.find(labels[v]), expected.find(v));
+    }
+    // vertices of the same set have the same label
+    std::unordered_map<std::uintptr_t, std::uintptr_t> label_of_set;
+    for (std::uintptr_t v = 0; v < n; ++v) {
+      auto pr = label_of_set.emplace(expected.find(v), labels[v]);
+      EXPECT_EQ(pr.first->second, labels[v]);
+    }
+  }
+  EXPECT_TRUE(hhxx::connected_components(edges.begin(), edges.begin(), 0)
+              .empty());
+}
+
+TEST(rollback_union_find_set, basic) {
+  hhxx::rollback_union_find_set ufset(6);
+  EXPECT_EQ(0u, ufset.checkpoint());
+  EXPECT_EQ(0u, ufset.unite(0, 1));
+  auto cp1 = ufset.checkpoint();
+  EXPECT_EQ(2u, ufset.unite(2, 3));
+  EXPECT_EQ(2u, ufset.unite(3, 4));
+  auto cp2 = ufset.checkpoint();
+  EXPECT_EQ(2u, ufset.unite(1, 4));
+  // no-op unions are not logged
+  EXPECT_EQ(2u, ufset.unite(0, 3));
+  EXPECT_EQ(cp2 + 1, ufset.checkpoint());
+  EXPECT_EQ(2u, ufset.find(0));
+  ufset.rollback(cp2);
+  EXPECT_EQ(0u, ufset.find(1));
+  EXPECT_EQ(2u, ufset.find(4));
+  // sizes are restored too; {0, 1} is smaller than {2, 3, 4}
+  EXPECT_EQ(2u, ufset.unite(5, 2));
+  ufset.rollback(cp1);
+  EXPECT_EQ(0u, ufset.find(1));
+  for (std::uintptr_t key = 2; key < 6; ++key) {
+    EXPECT_EQ(key, ufset.find(key));
+  }
+  EXPECT_EQ(5u, ufset.unite(5, 2));
+  ufset.rollback(0);
+  for (std::uintptr_t key = 0; key < 6; ++key) {
+    EXPECT_EQ(key, ufset.find(key));
+  }
+  ufset.unite(0, 1);
+  ufset.reset();
+  EXPECT_EQ(0u, ufset.checkpoint());
+  EXPECT_EQ(1u, ufset.find(1));
+}
+
+namespace union_find_set_test_ns {
+
+// Checks set queries of `ufset` over `{0, 1, 2, 3, 4, 5}` after
+// `{0, 2, 4}` and `{1, 3}` are united.
+template <class UnionFindSet>
+void check_members(UnionFindSet& ufset) {
+  std::vector<std::uintptr_t> members;
+  auto collect = [&](std::uintptr_t member) {
+    members.push_back(member);
+  };
+  ufset.for_each_member(4, collect);
+  std::sort(members.begin(), members.end());
+  EXPECT_EQ((std::vector<std::uintptr_t>{0, 2, 4}), members);
+  members.clear();
+  ufset.for_each_member(1, collect);
+  std::sort(members.begin(), members.end());
+  EXPECT_EQ((std::vector<std::uintptr_t>{1, 3}), members);
+  members.clear();
+  ufset.for_each_member(5, collect);
+  EXPECT_EQ((std::vector<std::uintptr_t>{5}), members);
+  EXPECT_EQ(3u, ufset.size_of(2));
+  EXPECT_EQ(2u, ufset.size_of(3));
+  EXPECT_EQ(1u, ufset.size_of(5));
+}
+
+} // namespace union_find_set_test_ns
+
+TEST(set_queries, basic) {
+  using union_find_set_test_ns::check_members;
+  hhxx::union_find_set ufset;
+  EXPECT_EQ(0u, ufset.num_sets());
+  ufset.unite(0, 2);
+  ufset.unite(1, 3);
+  ufset.unite(4, 0);
+  EXPECT_EQ(2u, ufset.num_sets());
+  check_members(ufset);
+  // 5 got referenced
+  EXPECT_EQ(3u, ufset.num_sets());
+  ufset.reset();
+  EXPECT_EQ(0u, ufset.num_sets());
+  hhxx::dense_union_find_set dense(6);
+  EXPECT_EQ(6u, dense.num_sets());
+  dense.unite(0, 2);
+  dense.unite(1, 3);
+  dense.unite(4, 0);
+  dense.unite(2, 4);
+  EXPECT_EQ(3u, dense.num_sets());
+  check_members(dense);
+  dense.reset();
+  EXPECT_EQ(6u, dense.num_sets());
+  EXPECT_EQ(1u, dense.size_of(0));
+}
+
+TEST(export_labels, keys) {
+  hhxx::union_find_set ufset;
+  hhxx::flat_union_find_set flat;
+  ufset.unite(10, 30);
+  ufset.unite(20, 40);
+  flat.unite(10, 30);
+  flat.unite(20, 40);
+  EXPECT_EQ(2u, ufset.compact());
+  EXPECT_EQ(2u, flat.compact());
+  std::vector<std::uintptr_t> keys{40, 50, 10, 20, 30, 40};
+  std::vector<int> expected{0, 1, 2, 0, 2, 0};
+  std::vector<int> labels(keys.size());
+  EXPECT_EQ(labels.end(),
+            ufset.export_labels(keys.begin(), keys.end(), labels.begin()));
+  EXPECT_EQ(expected, labels);
+  // sizes are intact
+  EXPECT_EQ(2u, ufset.size_of(10));
+  EXPECT_EQ(1u, ufset.size_of(50));
+  std::fill(labels.begin(), labels.end(), -1);
+  EXPECT_EQ(labels.end(),
+            flat.export_labels(keys.begin(), keys.end(), labels.begin()));
+  EXPECT_EQ(expected, labels);
+  EXPECT_EQ(2u, flat.size_of(40));
+  EXPECT_EQ(3u, flat.num_sets());
+  // insert iterators get labels of the container's value type
+  std::vector<short> shorts;
+  flat.export_labels(keys.begin(), keys.end(), std::back_inserter(shorts));
+  EXPECT_EQ(expected, std::vector<int>(shorts.begin(), shorts.end()));
+}
+
+TEST(export_labels, dense) {
+  hhxx::dense_union_find_set dense(1000);
+  hhxx::compact_union_find_set compact(1000);
+  for (std::uintptr_t i = 0; i < 700; ++i) {
+    auto a = i * 263 % 1000;
+    auto b = i * 379 % 1000;
+    dense.unite(a, b);
+    compact.unite(a, b);
+  }
+  // labels of sets are in increasing order of roots
+  std::vector<std::uintptr_t> expected(1000);
+  std::vector<std::uintptr_t> label_of_root(1000);
+  std::uintptr_t k = 0;
+  for (std::uintptr_t key = 0; key < 1000; ++key) {
+    if (dense.find(key) == key) label_of_root[key] = k++;
+  }
+  for (std::uintptr_t key = 0; key < 1000; ++key) {
+    expected[key] = label_of_root[dense.find(key)];
+  }
+  ASSERT_EQ(dense.num_sets(), k);
+  for (std::size_t num_threads = 1; num_threads <= 3; ++num_threads) {
+    std::vector<std::uintptr_t> labels(1000);
+    EXPECT_EQ(k, dense.export_labels(labels.begin(), num_threads));
+    EXPECT_EQ(expected, labels);
+    labels.assign(1000, 0);
+    EXPECT_EQ(k, compact.export_labels(labels.begin(), num_threads));
+    EXPECT_EQ(expected, labels);
+  }
+  EXPECT_EQ(k, compact.compact());
+  for (std::uintptr_t key = 0; key < 1000; ++key) {
+    EXPECT_EQ(dense.find(key), compact.find(key));
+  }
+}
+
+TEST(export_labels, narrow) {
+  // roots exceed the range of the output type, while labels don't
+  const std::size_t n = 70000;
+  hhxx::dense_union_find_set dense(n);
+  hhxx::compact_union_find_set compact(n);
+  for (std::uintptr_t key = 0; key + 1 < n; ++key) {
+    dense.unite(n - 1, key);
+    compact.unite(n - 1, key);
+  }
+  ASSERT_EQ(n - 1, dense.find(0));
+  for (std::size_t num_threads = 1; num_threads <= 2; ++num_threads) {
+    std::vector<std::uint16_t> labels(n, 1);
+    EXPECT_EQ(1u, dense.export_labels(labels.begin(), num_threads));
+    EXPECT_EQ(std::vector<std::uint16_t>(n, 0), labels);
+    labels.assign(n, 1);
+    EXPECT_EQ(1u, compact.export_labels(labels.begin(), num_threads));
+    EXPECT_EQ(std::vector<std::uint16_t>(n, 0), labels);
+  }
+}